@@ -5,10 +5,24 @@
 *                  Course code: COMP10002 2025 Semester 1                     *
 *============================================================================*/
 
+// Build: gcc -Wall -O2 -pthread a1.c -o a1 (add -mavx2 for the AVX2 bitset BFS)
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
 #include <stdbool.h>
-#include <stdio.h> 
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 /*==========================================================*
 *                 PREPROCESSOR DIRECTIVES                   *
@@ -19,173 +33,5311 @@
 #define BLOCK_SPACE 'X'
 #define PATH_SPACE '+'
 #define VISITED_SPACE '*'
-#define EMPTY_SPACE ' '  
-#define N 5
+#define EMPTY_SPACE ' '
+#define WORD_BITS 64
+#define BATCH_CHUNK 32
+#define QUERY_PATH 0
+#define QUERY_BLOCK 1
+#define QUERY_UNBLOCK 2
+#define UNREACHABLE 0x3fffffff
+#define MAP_FILE_MAGIC "A1MP"
+#define MAP_FILE_VERSION 1
+#define MAP_FILE_BYTE_ORDER 0x01020304u
+#define MAP_FILE_HAS_COSTS 1u
+#define CLUSTER_SIZE 16
+#define LAYOUT_ROWMAJOR 0
+#define LAYOUT_TILED 1
+#define LAYOUT_MORTON 2
+#define TILE_SIZE 8
+#define HPA_WIDE_ENTRANCE 6
+#define MAX_CELL_COST 255
+#define RADIX_BUCKETS 33
+#define RENDER_FULL 0
+#define RENDER_DIFF 1
+#define RENDER_COORDS 2
+#define RENDER_BUFFER_BYTES (1 << 22)
+#define BFS_BOTTOM_UP_ALPHA 14
+#define BFS_TOP_DOWN_BETA 24
+#define BFS_PHASE_OPEN 0
+#define BFS_PHASE_TOP_DOWN 1
+#define BFS_PHASE_BOTTOM_UP 2
+#define BFS_PHASE_MERGE 3
+#define BFS_PHASE_EXIT 4
 
-// Global direction vectors for up, right, down, left 
+// Global direction vectors for up, right, down, left
 static const int rowDir[4] = {-1, 0, 1, 0};
 static const int colDir[4] = {0, 1, 0, -1};
 
+/*==========================================================*
+*                      MAP REPRESENTATION                   *
+*==========================================================*/
+/* Heap-allocated grid whose size is read from the input. Each cell state
+ * lives in its own bit plane (one bit per cell, rows padded to whole
+ * 64-bit words), so a 4096x4096 map costs 2MB per plane instead of 16MB.
+ * Planes are row-major by default; LAYOUT_TILED packs each 8x8 tile into
+ * one word so vertical neighbours share a cache line, and LAYOUT_MORTON
+ * additionally orders the tiles along a Z-curve. Only the accessors below
+ * know the layout.
+ * START_SPACE and END_SPACE are kept as coordinates, not plane bits.
+ * An optional cost layer gives the price of stepping into each cell, one
+ * byte per cell id (row * cols + col) whatever the layout. */
+typedef struct components components_t;
+typedef struct search_stats search_stats_t;
+typedef struct renderer renderer_t;
+
+typedef struct grid_map {
+    int rows;                // Number of rows read from the input
+    int cols;                // Number of columns read from the input
+    int rowWords;            // 64-bit words per row (row-major layout)
+    int layout;              // LAYOUT_ROWMAJOR, LAYOUT_TILED or LAYOUT_MORTON
+    int tileCols;            // TILE_SIZE-wide tiles per row (tiled layout)
+    int mortonBits;          // Tile coordinate bits interleaved (Morton)
+    size_t planeWords;       // 64-bit words in every plane
+    uint64_t *blocked;       // BLOCK_SPACE cells
+    uint64_t *visited;       // VISITED_SPACE cells
+    uint64_t *path;          // PATH_SPACE cells
+    int startRow, startCol;  // START_SPACE, -1 until FillMap runs
+    int endRow, endCol;      // END_SPACE, -1 until FillMap runs
+    components_t *components;  // Optional connectivity index, owned
+    search_stats_t *stats;   // Optional solver counters, not owned
+    uint8_t *costs;          // Entry cost per cell id, NULL if all are 1
+    int minCost;             // Smallest entry in costs, 1 without a layer
+    renderer_t *renderer;    // PrintMap output mode, NULL for full frames
+    void *mapping;           // File mapping behind blocked, NULL if heap
+    size_t mappingBytes;     // Length of mapping
+} map_t;
+
+/* Header of the binary map format. The blocked plane follows it directly,
+ * rows * rowWords 64-bit words in row-major layout, so a row-major map_t
+ * uses a mapped file as-is. 64 bytes keeps the plane 8-byte aligned.
+ * With MAP_FILE_HAS_COSTS the cost layer follows the plane, rows * cols
+ * bytes; files written before the flag existed have zero flags. */
+typedef struct map_file_header {
+    char magic[4];           // MAP_FILE_MAGIC
+    uint32_t version;        // MAP_FILE_VERSION
+    uint32_t byteOrder;      // MAP_FILE_BYTE_ORDER as written by the host
+    int32_t rows, cols;
+    int32_t startRow, startCol;
+    int32_t endRow, endCol;
+    int32_t rowWords;
+    uint32_t flags;          // MAP_FILE_HAS_COSTS
+    uint32_t minCost;        // Smallest cost in the layer, 1 without one
+    uint8_t reserved[16];    // Zero
+} map_file_header_t;
+
+/* Run of free cells first..last (inclusive) in one row */
+typedef struct interval {
+    int row;
+    int first, last;
+} interval_t;
+
+/* Run-length form of a map: the maximal free runs of every row, in row
+ * then column order. Its size grows with the number of blocked cells
+ * (each one splits at most one run), not with the area. */
+typedef struct rle_map {
+    int rows, cols;
+    int *rowStart;           // Runs of row r are runs[rowStart[r]..rowStart[r + 1])
+    interval_t *runs;
+    int runCount, runCapacity;
+} rle_map_t;
+
+/* How PrintMap shows the map: RENDER_FULL draws every cell, RENDER_DIFF
+ * lists the cells whose character changed since the previous frame, and
+ * RENDER_COORDS lists the PATH_SPACE cells */
+struct renderer {
+    int mode;                // RENDER_FULL, RENDER_DIFF or RENDER_COORDS
+    uint64_t *shown;         // Blocked, visited and path planes as last drawn
+                             // (RENDER_DIFF), NULL before the first frame
+};
+
+/* Text of a frame, handed to write() in as few calls as possible */
+typedef struct frame {
+    char *data;
+    size_t length;
+    size_t capacity;
+} frame_t;
+
+/*==========================================================*
+*                        SEARCH STATE                       *
+*==========================================================*/
+/* Counters for the last solver run on a map with stats enabled (-stats).
+ * The depth-first solvers update them as they go; the others keep
+ * their own counters, copied over by the Level drivers (RecordStats). */
+struct search_stats {
+    long visited;            // Distinct cells (or abstract nodes) visited
+    long revisits;           // Times an already visited cell was reached
+    long backtracks;         // Dead ends unwound by depth-first search
+    int depth;               // Current depth-first stack depth
+    int maxDepth;            // Deepest depth-first stack reached
+    int pathLength;          // Steps on the path found, -1 if none
+    long long startedNs;     // Set by StatsBegin
+    long long elapsedNs;     // Wall time between StatsBegin and StatsEnd
+};
+
+/* FIFO of cell ids stored in one flat array that wraps around */
+typedef struct ring_queue {
+    int *items;     // Cell ids, capacity entries
+    int capacity;   // Maximum number of queued cells
+    int head;       // Index of the next cell to pop
+    int count;      // Number of cells currently queued
+} ring_queue_t;
+
+/* Binary min-heap over ids 0..capacity-1 with decrease-key. Ties on key
+ * go to the smaller id so every search is deterministic. */
+typedef struct index_heap {
+    int *items;      // Heap-ordered ids
+    int *pos;        // Slot of each id in items, -1 when not queued
+    uint64_t *key;   // Priority of each id, valid while queued
+    int size;        // Number of queued ids
+    int capacity;    // Largest id + 1
+} index_heap_t;
+
+/* Monotone radix heap of (key, cell) pairs: pushed keys may never be
+ * smaller than the last popped one. Bucket 0 holds keys equal to last and
+ * bucket b the keys whose highest bit differing from last is bit b - 1,
+ * so each item moves to a lower bucket at most 32 times. */
+typedef struct radix_item {
+    uint32_t key;
+    int cell;
+} radix_item_t;
+
+typedef struct radix_heap {
+    radix_item_t *items[RADIX_BUCKETS];
+    int count[RADIX_BUCKETS];
+    int capacity[RADIX_BUCKETS];
+    uint32_t last;           // Key of the last pop, 0 after RadixClear
+    int size;                // Items in all buckets
+} radix_heap_t;
+
+/* Row-major bitsets for word-parallel BFS. Every plane has one zero guard
+ * row above and below the map and one zero guard word at each end of a
+ * row, so shifts and row neighbours never need bounds checks. */
+typedef struct bitset_bfs {
+    int rows;            // Map rows
+    int rowWords;        // 64-bit words holding one map row
+    int stride;          // rowWords + 2 guard words
+    uint64_t *open;      // Free cells of the map
+    uint64_t *reached;   // Cells reached so far
+    uint64_t *frontier;  // Cells first reached by the last layer
+    uint64_t *next;      // Layer being built
+} bitset_bfs_t;
+
+/* Connected-component label of every open cell (0 for blocked cells),
+ * so two cells in different components are rejected in O(1) */
+struct components {
+    int *label;              // Component of each cell id
+    int nextLabel;           // Next unused label
+    ring_queue_t queue;      // Flood-fill frontier
+};
+
+/* D* Lite state: g and rhs are distances to END, searched backwards so
+ * START can be re-planned after map edits without starting over */
+typedef struct dstar {
+    map_t *map;
+    int start, goal;         // Cell ids of START and END
+    int *g;                  // Settled distance to END, UNREACHABLE if none
+    int *rhs;                // One-step lookahead of g
+    index_heap_t *open;      // Cells whose g and rhs disagree
+    long expanded;           // Cells popped by the last DStarPlan
+} dstar_t;
+
+/* Growable array of ints */
+typedef struct int_list {
+    int *items;
+    int count;
+    int capacity;
+} int_list_t;
+
+/* Entrance of an HPA* cluster. Nodes come in pairs, one on each side of
+ * a cluster border; edges/costs hold the cached shortest in-cluster
+ * distance to every other reachable entrance of the same cluster. */
+typedef struct hpa_node {
+    int cell;                // Cell id of the entrance
+    int cluster;             // Cluster holding cell
+    int partner;             // Node one step away across the border
+    int_list_t edges;        // Node ids in the same cluster
+    int_list_t costs;        // Steps to each of edges
+    int goalCost;            // Steps to END during a query, -1 otherwise
+    bool alive;              // False while on the free list
+} hpa_node_t;
+
+/* Abstract graph for hierarchical pathfinding over CLUSTER_SIZE square
+ * clusters. borders[2c] holds the node pairs on the right border of
+ * cluster c and borders[2c + 1] those on its bottom border. */
+typedef struct hpa {
+    map_t *map;
+    int clusterRows, clusterCols;
+    hpa_node_t *nodes;
+    int nodeCount, nodeCapacity;
+    int_list_t freeNodes;    // Ids of dead nodes, reused first
+    int_list_t *borders;
+    int_list_t scratch;      // Nodes of one cluster
+    int *localDist;          // In-cluster BFS distances, -1 if unreached
+    int *localParent;        // In-cluster BFS predecessors
+    int *localQueue;         // In-cluster BFS frontier
+    int searchCapacity;      // Ids g, parent and open can hold
+    int *g;                  // Abstract steps from START
+    int *parent;             // Abstract predecessor, -1 for START's links
+    index_heap_t *open;      // Abstract A* open list
+    long expanded;           // Abstract nodes popped by the last query
+} hpa_t;
+
+/* One line of a batch run: a (start, end) question and its answer, or
+ * a "block/unblock row col" event that changes the map for later ones */
+typedef struct query {
+    int kind;                // QUERY_PATH, QUERY_BLOCK or QUERY_UNBLOCK
+    int startRow, startCol;  // Event cell for QUERY_BLOCK/QUERY_UNBLOCK
+    int endRow, endCol;
+    int steps;               // Shortest path length, -1 if unreachable
+} query_t;
+
+/* BFS distances from every cell to one destination, shared read-only by
+ * the batch workers once built */
+typedef struct distance_field {
+    int end;                 // Cell id of the destination
+    int *dist;               // Steps to end per cell id, UNREACHABLE if none
+    int refs;                // Workers holding the field
+    bool built;              // dist is complete
+    struct distance_field *prev, *next;  // LRU list, most recent first
+} distance_field_t;
+
+/* Distance fields kept under a memory budget, least recently used first
+ * out. Entries held by a worker (refs > 0) are never evicted. */
+typedef struct field_cache {
+    const map_t *map;
+    size_t budget;           // Bytes the fields may take
+    size_t used;             // Bytes the fields take
+    distance_field_t *head, *tail;
+    long hits, misses;
+    pthread_mutex_t lock;    // Guards everything but a built field's dist
+    pthread_cond_t ready;    // Broadcast when a field finishes building
+} field_cache_t;
+
+/* Thread of the batch worker pool; worker 0 is the calling thread */
+typedef struct batch_worker {
+    struct batch *batch;
+    struct search_ctx *ctx;  // Private scratch buffers, kept for every run
+    pthread_t thread;
+} batch_worker_t;
+
+/* Work shared by the batch worker pool. The pool is started once and
+ * parks on the start barrier between runs of queries; the map is
+ * read-only while the workers run. */
+typedef struct batch {
+    const map_t *map;
+    query_t *queries;
+    int count;               // End of the run of queries being answered
+    int next;                // First query not yet claimed by a worker
+    pthread_mutex_t lock;    // Guards next
+    field_cache_t *fields;   // Distance field cache, NULL unless -fields
+    int threads;
+    bool done;               // Set to release the pool for good
+    batch_worker_t *workers;
+    pthread_barrier_t start; // Releases the pool into a run
+    pthread_barrier_t finish;  // Waits for every worker to finish the run
+} batch_t;
+
+/* Scratch buffers for the iterative solvers, indexed by cell id
+ * (row * cols + col). The map itself is only read during a search.
+ * A cell counts as seen when its stamp equals the current generation, so
+ * starting a query bumps one counter instead of clearing every cell and
+ * a short query on a large map only pays for the cells it touches. That
+ * only holds while the context lives: long-running callers such as the
+ * batch pool keep one per thread and never recreate it between queries. */
+typedef struct search_ctx {
+    int cells;           // Number of cell ids the buffers can hold
+    int *parent;         // Predecessor on the search tree, valid once seen
+    uint32_t *stamp;     // Generation in which each cell was last seen
+    uint32_t generation; // Stamp of the current query, never 0
+    long seenCount;      // Cells seen by the current query
+    ring_queue_t queue;  // BFS frontier
+    int *gScore;         // Cost from START, allocated by the first A*/Dijkstra
+    index_heap_t *heap;  // A*/JPS open list, allocated by the first one
+    radix_heap_t *radix; // Dijkstra open list, allocated by the first one
+    uint64_t *fromEnd;   // END side bit of each seen cell (bidirectional)
+    ring_queue_t backQueue;  // END side frontier, allocated with fromEnd
+    long expanded;       // Cells taken off the frontier by the last search
+    long revisits;       // Neighbours found already seen by the last search
+} search_ctx_t;
+
+/* Thread of a parallel BFS pool; worker 0 is the calling thread */
+typedef struct bfs_worker {
+    struct parallel_bfs *bfs;
+    int id;
+    int_list_t found;        // Cells this thread added to the next level
+    pthread_t thread;
+} bfs_worker_t;
+
+/* Level-synchronous BFS over a pthread pool, bitmaps indexed by cell id.
+ * A top-down level splits the frontier between the threads, which claim
+ * unvisited neighbours with an atomic fetch-or on visited; a bottom-up
+ * level splits the bitmap words instead, and every unvisited free cell
+ * looks for a visited neighbour. The frontier size picks the direction. */
+typedef struct parallel_bfs {
+    const map_t *map;
+    int threads;
+    size_t words;            // 64-bit words in each bitmap
+    uint64_t *open;          // Free cells
+    uint64_t *visited;       // Cells reached so far
+    uint64_t *fresh;         // Cells found by the running bottom-up level
+    long openCount;          // Bits set in open
+    int *frontier;           // Cells of the level being expanded
+    int frontierCount, frontierCapacity;
+    int phase;               // BFS_PHASE_* the pool runs next
+    bfs_worker_t *workers;
+    pthread_barrier_t start; // Releases the pool into phase
+    pthread_barrier_t finish;  // Waits for every slice of phase
+    long reached;            // Cells visited by the last query
+    int levels;              // Levels expanded by the last query
+    int bottomUpLevels;      // How many of them ran bottom-up
+} parallel_bfs_t;
+
+/* Open-addressing hash from (cell, time) to an int, used both for the
+ * space-time reservations (value: agent) and for the closed states of
+ * one space-time search (value: node) */
+typedef struct st_table {
+    uint64_t *keys;          // Packed (time, cell) + 1, 0 for an empty slot
+    int *values;
+    size_t capacity;         // Slots, a power of two
+    size_t count;            // Slots in use, at most half of capacity
+} st_table_t;
+
+/* State of a space-time search: cell at a time step, with the state it
+ * was reached from */
+typedef struct st_node {
+    int cell;
+    int time;
+    int parent;              // Node index, -1 for the agent's start
+} st_node_t;
+
+/* One robot of a cooperative run and the path planned for it */
+typedef struct agent {
+    int startRow, startCol;
+    int endRow, endCol;
+    int *path;               // Cell id at times 0..steps, NULL if unplanned
+    int steps;               // Time the agent parks on END, -1 if no path
+    int waits;               // Time steps spent standing still
+} agent_t;
+
+/* Cooperative A*: agents are planned one after another, each avoiding
+ * the cells the earlier ones reserved at every time step, and then stays
+ * parked on its END for good */
+typedef struct cooperative {
+    const map_t *map;
+    st_table_t reserved;     // (cell, time) -> agent holding the cell
+    int *parkedAt;           // Time an agent parks on each cell, -1 if none
+    int *lastUse;            // Latest reserved time of each cell, -1 if none
+    int stableTime;          // Latest reserved time of any cell
+    st_table_t closed;       // (cell, time) -> node, for the running search
+    st_node_t *nodes;
+    int nodeCount, nodeCapacity;
+    radix_heap_t *open;      // Nodes keyed by f = time + Manhattan distance
+    long expanded;           // States expanded by every search so far
+} cooperative_t;
+
+/* Map family of the benchmark: generate fills an empty map from the
+ * random state and places START/END */
+typedef struct bench_family {
+    const char *name;
+    void (*generate)(map_t *map, uint64_t *rng, int param);
+    int param;               // Passed through to generate
+} bench_family_t;
+
+/* Benchmark adapter: runs one solver on a refreshed map from its START to
+ * END and reports cells expanded. Returns the path length, -1 if none. */
+typedef struct bench_solver {
+    const char *name;
+    int (*run)(map_t *map, search_ctx_t *ctx, long *expanded);
+} bench_solver_t;
+
+/* One cell on the FindPath stack and the next direction to try from it */
+typedef struct dfs_frame {
+    int row, col;
+    int dir;                 // Index into rowDir/colDir, 4 when exhausted
+} dfs_frame_t;
+
 /*==========================================================*
 *                   FUNCTION PROTOTYPES                     *
 *==========================================================*/
 /*----------------------------------------------------------*
 *                    PROVIDED FUNCTIONS                     *
 *----------------------------------------------------------*/
-void ClearMap(char MAP[][N]);
-void RefreshMap(char MAP[][N]);
+void ClearMap(map_t *map);
+void RefreshMap(map_t *map);
 void LevelHeader(int LevelNum);
 
-void Level01(char MAP[][N], int startRow, int startColumn, int endRow,
+void Level01(map_t *map, int startRow, int startColumn, int endRow,
              int endColumn);
-void Level02(char MAP[][N], int startRow, int startColumn, int endRow,
+void Level02(map_t *map, int startRow, int startColumn, int endRow,
              int endColumn);
-void Level03(char MAP[][N], int startRow, int startColumn);
-void Level04(char MAP[][N], int startRow, int startColumn);
+void Level03(map_t *map, int startRow, int startColumn);
+void Level04(map_t *map, int startRow, int startColumn);
 
 /*----------------------------------------------------------*
 *                  FUNCTIONS TO COMPLETE                    *
 *----------------------------------------------------------*/
 // Render map
-void PrintMap(char MAP[][N]);
+void PrintMap(const map_t *map);
 // Map maintenance
-void FillMap(char MAP[][N], int *startRow, int *startColumn, int *endRow,
+void FillMap(map_t *map, int *startRow, int *startColumn, int *endRow,
              int *endColumn);
 // Pathfinding algorithms
-int SimpleDirections(char MAP[][N], int startRow, int startColumn, int endRow,
+int SimpleDirections(map_t *map, int startRow, int startColumn, int endRow,
                      int endColumn);
-void ClosestFreeNeighbour(char MAP[][N], int currentRow, int currentColumn);
-bool ImprovedPathfinding(char MAP[][N], int currentRow, int currentColumn);
+void ClosestFreeNeighbour(map_t *map, int currentRow, int currentColumn);
+bool ImprovedPathfinding(map_t *map, int currentRow, int currentColumn);
 
 /*----------------------------------------------------------*
 *        SPACE FOR YOUR OWN CUSTOM HELPER FUNCTIONS         *
 *----------------------------------------------------------*/
-int IsValidMove(char MAP[][N], int row, int col);
-bool AttemptMove(char MAP[][N], int *curRow, int *curCol,
+// Map storage
+map_t *CreateMap(int rows, int cols, int layout);
+map_t *ReadMapDimensions(int layout);
+void FreeMap(map_t *map);
+map_t *LoadBinaryMap(const char *path, int layout);
+void WriteBinaryMap(const map_t *map, const char *path);
+void ReadCosts(map_t *map);
+bool InBounds(const map_t *map, int row, int col);
+bool IsBlocked(const map_t *map, int row, int col);
+bool IsVisited(const map_t *map, int row, int col);
+bool IsPath(const map_t *map, int row, int col);
+void SetBlocked(map_t *map, int row, int col);
+void ClearBlocked(map_t *map, int row, int col);
+void SetVisited(map_t *map, int row, int col);
+void SetPath(map_t *map, int row, int col);
+char CellAt(const map_t *map, int row, int col);
+// Rendering
+renderer_t *CreateRenderer(int mode);
+void FreeRenderer(renderer_t *renderer);
+// Movement
+int IsValidMove(const map_t *map, int row, int col);
+bool AttemptMove(map_t *map, int *curRow, int *curCol,
                  int rowDir, int colDir, int *steps);
-bool IsStuck(char MAP[][N], int curRow, int curCol);
-bool FindPath(char MAP[][N], int curRow, int curCol, bool visited[][N]);
+bool IsStuck(const map_t *map, int curRow, int curCol);
+bool FindPath(map_t *map, int curRow, int curCol);
+// Iterative search
+search_ctx_t *CreateSearchContext(int cells);
+void FreeSearchContext(search_ctx_t *ctx);
+void ResetSearchContext(search_ctx_t *ctx);
+void QueuePush(ring_queue_t *queue, int cell);
+int QueuePop(ring_queue_t *queue);
+index_heap_t *CreateHeap(int capacity);
+void FreeHeap(index_heap_t *heap);
+void HeapPush(index_heap_t *heap, int id, uint64_t key);
+int HeapPop(index_heap_t *heap);
+void HeapRemove(index_heap_t *heap, int id);
+void HeapClear(index_heap_t *heap);
+int ManhattanDistance(int row1, int col1, int row2, int col2);
+int ShortestPath(const map_t *map, search_ctx_t *ctx, int startRow,
+                 int startColumn, int endRow, int endColumn);
+int MarkSearchPath(map_t *map, const search_ctx_t *ctx, int endRow,
+                   int endColumn);
+void MarkSearchVisited(map_t *map, const search_ctx_t *ctx);
+int AStarPath(const map_t *map, search_ctx_t *ctx, int startRow,
+              int startColumn, int endRow, int endColumn);
+int JumpPointSearch(const map_t *map, search_ctx_t *ctx, int startRow,
+                    int startColumn, int endRow, int endColumn);
+int MarkJumpPath(map_t *map, const search_ctx_t *ctx, int endRow,
+                 int endColumn);
+int BidirectionalPath(const map_t *map, search_ctx_t *ctx, int startRow,
+                      int startColumn, int endRow, int endColumn);
+bitset_bfs_t *CreateBitsetBfs(const map_t *map);
+void FreeBitsetBfs(bitset_bfs_t *bfs);
+int BitsetDistance(bitset_bfs_t *bfs, int startRow, int startColumn,
+                   int endRow, int endColumn);
+void Level05(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn);
+void Level06(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn);
+void Level07(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn);
+void Level08(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn);
+void Level09(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn);
+void Level10(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn);
+void Level11(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn);
+void Level12(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn);
+void Level13(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn);
+void Level14(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn, int threads);
+void Level15(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn);
+void Level16(map_t *map);
+// Weighted terrain
+radix_heap_t *CreateRadixHeap(void);
+void FreeRadixHeap(radix_heap_t *heap);
+void RadixPush(radix_heap_t *heap, uint32_t key, int cell);
+int RadixPop(radix_heap_t *heap, uint32_t *key);
+void RadixClear(radix_heap_t *heap);
+int DijkstraPath(const map_t *map, search_ctx_t *ctx, int startRow,
+                 int startColumn, int endRow, int endColumn);
+int WeightedAStarPath(const map_t *map, search_ctx_t *ctx, int startRow,
+                      int startColumn, int endRow, int endColumn);
+// Component index
+components_t *BuildComponents(const map_t *map);
+void FreeComponents(components_t *components);
+bool MayReach(const map_t *map, int startRow, int startColumn, int endRow,
+              int endColumn);
+void AddBlock(map_t *map, int row, int col);
+void RemoveBlock(map_t *map, int row, int col);
+// Incremental replanning
+dstar_t *CreateDStar(map_t *map, int startRow, int startColumn, int endRow,
+                     int endColumn);
+void FreeDStar(dstar_t *dstar);
+int DStarPlan(dstar_t *dstar);
+void DStarSetBlocked(dstar_t *dstar, int row, int col, bool blocked);
+int MarkDStarPath(map_t *map, const dstar_t *dstar);
+// Hierarchical pathfinding
+hpa_t *BuildHierarchy(map_t *map);
+void FreeHierarchy(hpa_t *hpa);
+void HierarchyCellChanged(hpa_t *hpa, int row, int col);
+int HierarchicalPath(hpa_t *hpa, int startRow, int startColumn, int endRow,
+                     int endColumn, bool mark);
+// Distance field cache
+field_cache_t *CreateFieldCache(const map_t *map, size_t budget);
+void FlushFieldCache(field_cache_t *cache);
+void FreeFieldCache(field_cache_t *cache);
+distance_field_t *AcquireField(field_cache_t *cache, search_ctx_t *ctx,
+                               int end);
+void ReleaseField(field_cache_t *cache, distance_field_t *field);
+int FollowField(const map_t *map, const distance_field_t *field, int row,
+                int col, int *cells);
+// Batch queries
+query_t *ReadQueries(int *count);
+void *BatchWorker(void *arg);
+void RunBatch(map_t *map, int threads, size_t fieldBytes);
+// Parallel BFS
+parallel_bfs_t *CreateParallelBfs(const map_t *map, int threads);
+void FreeParallelBfs(parallel_bfs_t *bfs);
+int ParallelDistance(parallel_bfs_t *bfs, int startRow, int startColumn,
+                     int endRow, int endColumn);
+// Run-length rows
+rle_map_t *BuildRleMap(const map_t *map);
+void FreeRleMap(rle_map_t *rle);
+int FindRun(const rle_map_t *rle, int row, int col);
+int IntervalReach(const rle_map_t *rle, int startRow, int startColumn,
+                  int endRow, int endColumn, bool *seen, int *runsExpanded);
+// Cooperative pathfinding
+cooperative_t *CreateCooperative(const map_t *map);
+void FreeCooperative(cooperative_t *coop);
+agent_t *ReadAgents(int *count);
+void PlanAgents(cooperative_t *coop, agent_t *agents, int count);
+// Search statistics
+void StatsBegin(map_t *map);
+void StatsEnd(map_t *map);
+void RecordStats(map_t *map, long visited, long revisits, int pathLength);
+void RecordContextStats(map_t *map, const search_ctx_t *ctx, int pathLength);
+void PrintStats(const search_stats_t *stats);
+// Benchmark
+void RunBenchmark(uint64_t seed, int layout);
+
+/**
+ * @brief: Inserts a zero bit above each bit of value (Morton encoding)
+ * @return: Bits of value at the even positions of the result
+*/
+static inline uint64_t SpreadBits(uint32_t value) {
+    uint64_t bits = value;
+    bits = (bits | bits << 16) & 0x0000ffff0000ffffull;
+    bits = (bits | bits << 8) & 0x00ff00ff00ff00ffull;
+    bits = (bits | bits << 4) & 0x0f0f0f0f0f0f0f0full;
+    bits = (bits | bits << 2) & 0x3333333333333333ull;
+    bits = (bits | bits << 1) & 0x5555555555555555ull;
+    return bits;
+}
+
+/**
+ * @brief: Bit position of a cell inside any of the map's planes
+ * @return: Bit offset from the start of the plane
+*/
+static inline size_t BitIndex(const map_t *map, int row, int col) {
+    if (map->layout == LAYOUT_ROWMAJOR) {
+        return (size_t)row * map->rowWords * WORD_BITS + (size_t)col;
+    }
+
+    uint32_t tileRow = (uint32_t)row / TILE_SIZE;
+    uint32_t tileCol = (uint32_t)col / TILE_SIZE;
+    size_t word;
+    if (map->layout == LAYOUT_TILED) {
+        word = (size_t)tileRow * map->tileCols + tileCol;
+    } else {
+        /* Interleave the low mortonBits of both tile coordinates; the
+         * longer side's remaining bits sit above them */
+        uint32_t low = ((uint32_t)1 << map->mortonBits) - 1;
+        word = (size_t)(SpreadBits(tileRow & low) << 1 | SpreadBits(tileCol & low)) |
+               (size_t)((tileRow | tileCol) >> map->mortonBits) << (2 * map->mortonBits);
+    }
+    return word * WORD_BITS + (size_t)(row % TILE_SIZE) * TILE_SIZE + col % TILE_SIZE;
+}
+
+static inline bool TestBit(const uint64_t *plane, size_t bit) {
+    return (plane[bit / WORD_BITS] >> (bit % WORD_BITS)) & 1u;
+}
+
+static inline void SetBit(uint64_t *plane, size_t bit) {
+    plane[bit / WORD_BITS] |= (uint64_t)1 << (bit % WORD_BITS);
+}
+
+static inline void AssignBit(uint64_t *plane, size_t bit, bool value) {
+    uint64_t mask = (uint64_t)1 << (bit % WORD_BITS);
+    plane[bit / WORD_BITS] = (plane[bit / WORD_BITS] & ~mask) |
+                             ((uint64_t)value << (bit % WORD_BITS));
+}
+
+static inline size_t PlaneBytes(const map_t *map) {
+    return map->planeWords * sizeof(uint64_t);
+}
+
+static inline long long NowNanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static inline int CeilLog2(int value) {
+    int bits = 0;
+    while ((1 << bits) < value) {
+        bits++;
+    }
+    return bits;
+}
+
+/**
+ * @brief: Allocates a rows x cols map with zeroed visited and path planes,
+ *         and a zeroed blocked plane too unless the caller supplies one
+ * @return: Pointer to the new map, exits on failure
+*/
+static map_t *NewMap(int rows, int cols, int layout, bool allocateBlocked) {
+    if (rows <= 0 || cols <= 0 || (long long)rows * cols > INT32_MAX) {
+        fprintf(stderr, "Error: invalid map size %d x %d\n", rows, cols);
+        exit(EXIT_FAILURE);
+    }
+
+    map_t *map = malloc(sizeof(*map));
+    if (map == NULL) {
+        fprintf(stderr, "Error allocating map\n");
+        exit(EXIT_FAILURE);
+    }
+
+    map->rows = rows;
+    map->cols = cols;
+    map->rowWords = (cols + WORD_BITS - 1) / WORD_BITS;
+    map->layout = layout;
+    map->tileCols = (cols + TILE_SIZE - 1) / TILE_SIZE;
+    map->mortonBits = 0;
+    int tileRows = (rows + TILE_SIZE - 1) / TILE_SIZE;
+    if (layout == LAYOUT_TILED) {
+        map->planeWords = (size_t)tileRows * map->tileCols;
+    } else if (layout == LAYOUT_MORTON) {
+        /* Pad each tile side to a power of two: at most 4x the tiles */
+        int rowBits = CeilLog2(tileRows), colBits = CeilLog2(map->tileCols);
+        map->mortonBits = (rowBits < colBits) ? rowBits : colBits;
+        map->planeWords = (size_t)1 << (rowBits + colBits);
+    } else {
+        map->planeWords = (size_t)rows * map->rowWords;
+    }
+
+    map->blocked = NULL;
+    if (allocateBlocked) {
+        map->blocked = calloc(map->planeWords, sizeof(uint64_t));
+    }
+    map->visited = calloc(map->planeWords, sizeof(uint64_t));
+    map->path = calloc(map->planeWords, sizeof(uint64_t));
+    if ((allocateBlocked && map->blocked == NULL) ||
+        map->visited == NULL || map->path == NULL) {
+        fprintf(stderr, "Error allocating %d x %d map\n", rows, cols);
+        exit(EXIT_FAILURE);
+    }
+
+    map->startRow = map->startCol = -1;
+    map->endRow = map->endCol = -1;
+    map->components = NULL;
+    map->stats = NULL;
+    map->costs = NULL;
+    map->minCost = 1;
+    map->renderer = NULL;
+    map->mapping = NULL;
+    map->mappingBytes = 0;
+    return map;
+}
+
+/**
+ * @brief: Allocates an empty rows x cols map with zeroed planes
+ * @return: Pointer to the new map, exits on failure
+*/
+map_t *CreateMap(int rows, int cols, int layout) {
+    return NewMap(rows, cols, layout, true);
+}
+
+/**
+ * @brief: Reads the "rows cols" line that starts every map file
+ * @return: Newly allocated map of that size
+*/
+map_t *ReadMapDimensions(int layout) {
+    int rows, cols;
+
+    if (scanf("%d %d", &rows, &cols) != 2) {
+        fprintf(stderr, "Error reading map dimensions\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return CreateMap(rows, cols, layout);
+}
+
+void FreeMap(map_t *map) {
+    if (map == NULL) {
+        return;
+    }
+
+    if (map->mapping != NULL) {
+        munmap(map->mapping, map->mappingBytes);
+    } else {
+        free(map->blocked);
+        free(map->costs);
+    }
+    free(map->visited);
+    free(map->path);
+    FreeComponents(map->components);
+    FreeRenderer(map->renderer);
+    free(map);
+}
+
+/**
+ * @brief: Exits unless every path cost fits below UNREACHABLE; a path
+ *         enters each cell at most once, so cells * MAX_CELL_COST bounds it
+*/
+static void RequireCostRange(const map_t *map) {
+    if ((long long)map->rows * map->cols * MAX_CELL_COST >= UNREACHABLE) {
+        fprintf(stderr, "Error: map too large for a cost layer\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief: Maps a binary map file into memory. For a row-major map the
+ *         blocked plane is used straight from the mapping (copy-on-write,
+ *         so AddBlock never touches the file) and nothing is parsed;
+ *         other layouts copy the blocked cells into a fresh plane and the
+ *         cost layer, if any, into a fresh array
+ * @return: Pointer to the new map, exits on a bad or unreadable file
+*/
+map_t *LoadBinaryMap(const char *path, int layout) {
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        fprintf(stderr, "Error opening map file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    if ((size_t)info.st_size < sizeof(map_file_header_t)) {
+        fprintf(stderr, "Error: %s is too short to be a map file\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    size_t bytes = (size_t)info.st_size;
+    void *base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Error mapping map file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    const map_file_header_t *header = base;
+    if (memcmp(header->magic, MAP_FILE_MAGIC, 4) != 0 ||
+        header->version != MAP_FILE_VERSION ||
+        header->byteOrder != MAP_FILE_BYTE_ORDER) {
+        fprintf(stderr, "Error: %s is not a version %d map file for this "
+                "machine\n", path, MAP_FILE_VERSION);
+        exit(EXIT_FAILURE);
+    }
+
+    map_t *map = NewMap(header->rows, header->cols, layout,
+                        layout != LAYOUT_ROWMAJOR);
+    size_t planeBytes = (size_t)map->rows * map->rowWords * sizeof(uint64_t);
+    size_t costBytes = 0;
+    if (header->flags & MAP_FILE_HAS_COSTS) {
+        costBytes = (size_t)map->rows * map->cols;
+    }
+    if (header->rowWords != map->rowWords ||
+        bytes < sizeof(map_file_header_t) + planeBytes + costBytes ||
+        (costBytes > 0 && (header->minCost < 1 ||
+                           header->minCost > MAX_CELL_COST)) ||
+        !InBounds(map, header->startRow, header->startCol) ||
+        !InBounds(map, header->endRow, header->endCol)) {
+        fprintf(stderr, "Error: map file %s is corrupt\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    const uint64_t *plane =
+        (const uint64_t *)((const char *)base + sizeof(map_file_header_t));
+    uint8_t *costs = (uint8_t *)base + sizeof(map_file_header_t) + planeBytes;
+    if (costBytes > 0) {
+        RequireCostRange(map);
+        map->minCost = (int)header->minCost;
+    }
+    if (layout == LAYOUT_ROWMAJOR) {
+        map->blocked = (uint64_t *)plane;
+        if (costBytes > 0) {
+            map->costs = costs;
+        }
+        map->mapping = base;
+        map->mappingBytes = bytes;
+    } else {
+        if (costBytes > 0) {
+            map->costs = malloc(costBytes);
+            if (map->costs == NULL) {
+                fprintf(stderr, "Error allocating cost layer\n");
+                exit(EXIT_FAILURE);
+            }
+            memcpy(map->costs, costs, costBytes);
+        }
+        for (int row = 0; row < map->rows; row++) {
+            for (int w = 0; w < map->rowWords; w++) {
+                uint64_t bits = plane[(size_t)row * map->rowWords + w];
+                while (bits) {
+                    SetBlocked(map, row, w * WORD_BITS + __builtin_ctzll(bits));
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+    map->startRow = header->startRow;
+    map->startCol = header->startCol;
+    map->endRow = header->endRow;
+    map->endCol = header->endCol;
+    if (map->mapping == NULL) {
+        munmap(base, bytes);
+    }
+    return map;
+}
+
+/**
+ * @brief: Writes the map in the binary format read by LoadBinaryMap
+*/
+void WriteBinaryMap(const map_t *map, const char *path) {
+    map_file_header_t header;
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL) {
+        fprintf(stderr, "Error creating map file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAP_FILE_MAGIC, 4);
+    header.version = MAP_FILE_VERSION;
+    header.byteOrder = MAP_FILE_BYTE_ORDER;
+    header.rows = map->rows;
+    header.cols = map->cols;
+    header.startRow = map->startRow;
+    header.startCol = map->startCol;
+    header.endRow = map->endRow;
+    header.endCol = map->endCol;
+    header.rowWords = map->rowWords;
+    header.flags = (map->costs != NULL) ? MAP_FILE_HAS_COSTS : 0;
+    header.minCost = (uint32_t)map->minCost;
+
+    /* The file is always row-major; other layouts are converted first */
+    size_t words = (size_t)map->rows * map->rowWords;
+    size_t cells = (size_t)map->rows * map->cols;
+    uint64_t *plane = map->blocked;
+    if (map->layout != LAYOUT_ROWMAJOR) {
+        plane = calloc(words, sizeof(uint64_t));
+        if (plane == NULL) {
+            fprintf(stderr, "Error allocating map file buffer\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int row = 0; row < map->rows; row++) {
+            for (int col = 0; col < map->cols; col++) {
+                if (IsBlocked(map, row, col)) {
+                    SetBit(plane, (size_t)row * map->rowWords * WORD_BITS + col);
+                }
+            }
+        }
+    }
+
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        fwrite(plane, sizeof(uint64_t), words, file) != words ||
+        (map->costs != NULL &&
+         fwrite(map->costs, 1, cells, file) != cells) ||
+        fclose(file) != 0) {
+        fprintf(stderr, "Error writing map file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    if (plane != map->blocked) {
+        free(plane);
+    }
+}
+
+/**
+ * @brief: Reads the optional cost layer after the blocks of a text map:
+ *         a "costs" line with the number of entries, then one
+ *         "row col cost" line per cell that does not cost 1 to enter.
+ *         Anything else (batch queries, events) is left unread
+*/
+void ReadCosts(map_t *map) {
+    int next, entries;
+
+    if (scanf(" ") == EOF || (next = getchar()) == EOF) {
+        return;
+    }
+    ungetc(next, stdin);
+    if (next != 'c') {
+        return;
+    }
+    if (scanf("costs %d", &entries) != 1 || entries < 0) {
+        fprintf(stderr, "Error reading number of costs\n");
+        exit(EXIT_FAILURE);
+    }
+    RequireCostRange(map);
+
+    size_t cells = (size_t)map->rows * map->cols;
+    map->costs = malloc(cells);
+    if (map->costs == NULL) {
+        fprintf(stderr, "Error allocating cost layer\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(map->costs, 1, cells);
+
+    for (int i = 0; i < entries; i++) {
+        int row, col, cost;
+
+        if (scanf("%d %d %d", &row, &col, &cost) != 3) {
+            fprintf(stderr, "Error reading cost #%d\n", i + 1);
+            exit(EXIT_FAILURE);
+        }
+        if (!InBounds(map, row, col) || cost < 1 || cost > MAX_CELL_COST) {
+            fprintf(stderr, "Error: cost #%d is out of range\n", i + 1);
+            exit(EXIT_FAILURE);
+        }
+        map->costs[(size_t)row * map->cols + col] = (uint8_t)cost;
+    }
+
+    map->minCost = MAX_CELL_COST;
+    for (size_t cell = 0; cell < cells; cell++) {
+        if (map->costs[cell] < map->minCost) {
+            map->minCost = map->costs[cell];
+        }
+    }
+}
+
+bool InBounds(const map_t *map, int row, int col) {
+    return row >= 0 && row < map->rows && col >= 0 && col < map->cols;
+}
+
+bool IsBlocked(const map_t *map, int row, int col) {
+    return TestBit(map->blocked, BitIndex(map, row, col));
+}
+
+bool IsVisited(const map_t *map, int row, int col) {
+    return TestBit(map->visited, BitIndex(map, row, col));
+}
+
+bool IsPath(const map_t *map, int row, int col) {
+    return TestBit(map->path, BitIndex(map, row, col));
+}
+
+void SetBlocked(map_t *map, int row, int col) {
+    SetBit(map->blocked, BitIndex(map, row, col));
+}
+
+void ClearBlocked(map_t *map, int row, int col) {
+    size_t bit = BitIndex(map, row, col);
+    map->blocked[bit / WORD_BITS] &= ~((uint64_t)1 << (bit % WORD_BITS));
+}
+
+void SetVisited(map_t *map, int row, int col) {
+    SetBit(map->visited, BitIndex(map, row, col));
+}
+
+void SetPath(map_t *map, int row, int col) {
+    SetBit(map->path, BitIndex(map, row, col));
+}
+
+/**
+ * @brief: Combines the planes into the character the cell would hold in
+ *         the original char MAP, END_SPACE taking priority like FillMap
+ * @return: One of the *_SPACE characters
+*/
+char CellAt(const map_t *map, int row, int col) {
+    if (row == map->endRow && col == map->endCol) {
+        return END_SPACE;
+    }
+    if (row == map->startRow && col == map->startCol) {
+        return START_SPACE;
+    }
+    if (IsBlocked(map, row, col)) {
+        return BLOCK_SPACE;
+    }
+    if (IsPath(map, row, col)) {
+        return PATH_SPACE;
+    }
+    if (IsVisited(map, row, col)) {
+        return VISITED_SPACE;
+    }
+
+    return EMPTY_SPACE;
+}
+
+/**
+ * @brief: Checks if possible to step into a position
+ * @return: 1 if valid, 0 if invalid
+*/
+int IsValidMove(const map_t *map, int row, int col) {
+    if (!InBounds(map, row, col)) {
+        return 0;
+    }
+
+    char cell = CellAt(map, row, col);
+    return (cell == EMPTY_SPACE || cell == END_SPACE);
+}
+
+/**
+ * @brief: Attempts to step one position and marks it as part of MAP
+ * @return: True if can move, false if blocked
+*/
+bool AttemptMove(map_t *map, int *curRow, int *curCol,
+                 int rowStep, int colStep, int *steps) {
+    int nextRow = *curRow + rowStep;
+    int nextCol = *curCol + colStep;
+
+    if (!IsValidMove(map, nextRow, nextCol)) {
+        return false;
+    }
+
+    *curRow = nextRow;
+    *curCol = nextCol;
+
+    if (CellAt(map, nextRow, nextCol) == EMPTY_SPACE) {
+        SetPath(map, nextRow, nextCol);
+    }
+
+    (*steps)++;
+    return true;
+}
+
+/**
+ * @brief: Checks all 4 neighbour positions (up, right, down, left)
+ * @return: True if stuck, false if at least 1 valid move exists
+*/
+bool IsStuck(const map_t *map, int curRow, int curCol) {
+    for (int i = 0; i < 4; i++) {
+        if (IsValidMove(map, curRow + rowDir[i], curCol + colDir[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief: Depth-first pathfinding with backtracking, driven by a growable
+ *         stack on the heap instead of the call stack, so long corridors
+ *         cannot overflow it. Neighbours are tried in the order up, right,
+ *         down, left, exactly as the recursive version did: a cell is
+ *         marked VISITED_SPACE when entered, and once END_SPACE is next to
+ *         the top of the stack every cell on the stack except START_SPACE
+ *         is marked PATH_SPACE
+ *         The visited plane doubles as the old visited[][] array, so the
+ *         caller clears it (RefreshMap) before the first call
+ * @return: True if found path to END_SPACE, false otherwise
+*/
+bool FindPath(map_t *map, int curRow, int curCol) {
+    search_stats_t *stats = map->stats;
+
+    if (CellAt(map, curRow, curCol) == END_SPACE) {
+        if (stats != NULL) {
+            stats->pathLength = 0;
+        }
+        return true;
+    }
+
+    int capacity = 64, depth = 0;
+    dfs_frame_t *stack = malloc((size_t)capacity * sizeof(*stack));
+    if (stack == NULL) {
+        fprintf(stderr, "Error allocating search stack\n");
+        exit(EXIT_FAILURE);
+    }
+
+    stack[depth++] = (dfs_frame_t){curRow, curCol, 0};
+    SetVisited(map, curRow, curCol);
+    if (stats != NULL) {
+        stats->visited++;
+        stats->maxDepth = 1;
+    }
+
+    bool found = false;
+    while (depth > 0 && !found) {
+        dfs_frame_t *top = &stack[depth - 1];
+
+        if (top->dir == 4) {
+            depth--;
+            if (stats != NULL) {
+                stats->backtracks++;
+            }
+            continue;
+        }
+
+        int nextRow = top->row + rowDir[top->dir];
+        int nextCol = top->col + colDir[top->dir];
+        top->dir++;
+        if (!InBounds(map, nextRow, nextCol) ||
+            CellAt(map, nextRow, nextCol) == BLOCK_SPACE) {
+            continue;
+        }
+        if (IsVisited(map, nextRow, nextCol)) {
+            if (stats != NULL) {
+                stats->revisits++;
+            }
+            continue;
+        }
+        if (CellAt(map, nextRow, nextCol) == END_SPACE) {
+            found = true;
+            break;
+        }
+
+        if (depth == capacity) {
+            capacity *= 2;
+            stack = realloc(stack, (size_t)capacity * sizeof(*stack));
+            if (stack == NULL) {
+                fprintf(stderr, "Error growing search stack to %d cells\n",
+                        capacity);
+                exit(EXIT_FAILURE);
+            }
+        }
+        stack[depth++] = (dfs_frame_t){nextRow, nextCol, 0};
+        SetVisited(map, nextRow, nextCol);
+        if (stats != NULL) {
+            stats->visited++;
+            if (depth > stats->maxDepth) {
+                stats->maxDepth = depth;
+            }
+        }
+    }
+
+    if (found) {
+        for (int i = 1; i < depth; i++) {
+            SetPath(map, stack[i].row, stack[i].col);
+        }
+        if (stats != NULL) {
+            stats->pathLength = depth;
+        }
+    }
+
+    free(stack);
+    return found;
+}
+
+/*==========================================================*
+*                        RENDERING                          *
+*==========================================================*/
+renderer_t *CreateRenderer(int mode) {
+    renderer_t *renderer = malloc(sizeof(*renderer));
+    if (renderer == NULL) {
+        fprintf(stderr, "Error allocating renderer\n");
+        exit(EXIT_FAILURE);
+    }
+
+    renderer->mode = mode;
+    renderer->shown = NULL;
+    return renderer;
+}
+
+void FreeRenderer(renderer_t *renderer) {
+    if (renderer == NULL) {
+        return;
+    }
+
+    free(renderer->shown);
+    free(renderer);
+}
+
+/**
+ * @brief: Writes the buffered text to standard output and empties it
+*/
+static void FlushFrame(frame_t *frame) {
+    size_t done = 0;
+
+    while (done < frame->length) {
+        ssize_t written = write(STDOUT_FILENO, frame->data + done,
+                                frame->length - done);
+        if (written < 0) {
+            fprintf(stderr, "Error writing map\n");
+            exit(EXIT_FAILURE);
+        }
+        done += (size_t)written;
+    }
+    frame->length = 0;
+}
+
+/**
+ * @brief: Makes room for bytes more characters, flushing the frame first
+ *         once it would outgrow RENDER_BUFFER_BYTES
+ * @return: Where the next characters go
+*/
+static char *FrameSpace(frame_t *frame, size_t bytes) {
+    if (frame->length + bytes > frame->capacity) {
+        if (frame->length + bytes > RENDER_BUFFER_BYTES) {
+            FlushFrame(frame);
+        }
+
+        size_t capacity = (frame->capacity > 0) ? frame->capacity : 4096;
+        while (capacity < frame->length + bytes) {
+            capacity *= 2;
+        }
+        if (capacity != frame->capacity) {
+            frame->data = realloc(frame->data, capacity);
+            frame->capacity = capacity;
+            if (frame->data == NULL) {
+                fprintf(stderr, "Error allocating %zu byte frame\n", capacity);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    return frame->data + frame->length;
+}
+
+/**
+ * @brief: Appends "row col" and, unless cell is 0, " cell" on one line
+*/
+static void FrameCell(frame_t *frame, int row, int col, char cell) {
+    char *out = FrameSpace(frame, 32);
+    int length = (cell != 0) ? sprintf(out, "%d %d %c\n", row, col, cell)
+                             : sprintf(out, "%d %d\n", row, col);
+    frame->length += (size_t)length;
+}
+
+/**
+ * @brief: Character of a cell given its blocked, path and visited bits,
+ *         with the priorities of CellAt
+*/
+static inline char PlaneChar(const map_t *map, int row, int col,
+                             bool blocked, bool path, bool visited) {
+    if (row == map->endRow && col == map->endCol) {
+        return END_SPACE;
+    }
+    if (row == map->startRow && col == map->startCol) {
+        return START_SPACE;
+    }
+    return blocked ? BLOCK_SPACE : path ? PATH_SPACE
+                   : visited ? VISITED_SPACE : EMPTY_SPACE;
+}
+
+/**
+ * @brief: RENDER_FULL - the "[c]" grid PrintMap has always printed
+*/
+static void RenderFull(const map_t *map, frame_t *frame) {
+    size_t rowBytes = (size_t)map->cols * 3 + 1;
+
+    for (int row = 0; row < map->rows; row++) {
+        char *out = FrameSpace(frame, rowBytes);
+        for (int col = 0; col < map->cols; col++) {
+            size_t bit = BitIndex(map, row, col);
+            out[0] = '[';
+            out[1] = PlaneChar(map, row, col, TestBit(map->blocked, bit),
+                               TestBit(map->path, bit),
+                               TestBit(map->visited, bit));
+            out[2] = ']';
+            out += 3;
+        }
+        *out = '\n';
+        frame->length += rowBytes;
+    }
+}
+
+/**
+ * @brief: RENDER_DIFF - one "row col c" line per cell whose character
+ *         differs from the previous frame (from EMPTY_SPACE for the
+ *         first one), then remembers the planes for the next frame
+*/
+static void RenderDiff(const map_t *map, frame_t *frame) {
+    renderer_t *renderer = map->renderer;
+    size_t words = map->planeWords;
+    bool first = renderer->shown == NULL;
+
+    if (first) {
+        renderer->shown = malloc(3 * words * sizeof(uint64_t));
+        if (renderer->shown == NULL) {
+            fprintf(stderr, "Error allocating render planes\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    const uint64_t *blocked = renderer->shown;
+    const uint64_t *visited = blocked + words;
+    const uint64_t *path = visited + words;
+    for (int row = 0; row < map->rows; row++) {
+        for (int col = 0; col < map->cols; col++) {
+            size_t bit = BitIndex(map, row, col);
+            char now = PlaneChar(map, row, col, TestBit(map->blocked, bit),
+                                 TestBit(map->path, bit),
+                                 TestBit(map->visited, bit));
+            char before = first ? EMPTY_SPACE
+                                : PlaneChar(map, row, col,
+                                            TestBit(blocked, bit),
+                                            TestBit(path, bit),
+                                            TestBit(visited, bit));
+            if (now != before) {
+                FrameCell(frame, row, col, now);
+            }
+        }
+    }
+
+    memcpy(renderer->shown, map->blocked, words * sizeof(uint64_t));
+    memcpy(renderer->shown + words, map->visited, words * sizeof(uint64_t));
+    memcpy(renderer->shown + 2 * words, map->path, words * sizeof(uint64_t));
+}
+
+/**
+ * @brief: RENDER_COORDS - one "row col" line per PATH_SPACE cell, in row
+ *         order
+*/
+static void RenderCoords(const map_t *map, frame_t *frame) {
+    for (int row = 0; row < map->rows; row++) {
+        for (int col = 0; col < map->cols; col++) {
+            if (CellAt(map, row, col) == PATH_SPACE) {
+                FrameCell(frame, row, col, 0);
+            }
+        }
+    }
+}
+
+/*==========================================================*
+*                     ITERATIVE SEARCH                      *
+*==========================================================*/
+static inline int CellId(const map_t *map, int row, int col) {
+    return row * map->cols + col;
+}
+
+static inline bool CtxSeen(const search_ctx_t *ctx, int cell) {
+    return ctx->stamp[cell] == ctx->generation;
+}
+
+static inline void CtxMarkSeen(search_ctx_t *ctx, int cell, int parent) {
+    ctx->seenCount += ctx->stamp[cell] != ctx->generation;
+    ctx->stamp[cell] = ctx->generation;
+    ctx->parent[cell] = parent;
+}
+
+/**
+ * @brief: Allocates scratch buffers for searches over up to cells cells
+ * @return: Pointer to the new context, exits on failure
+*/
+search_ctx_t *CreateSearchContext(int cells) {
+    search_ctx_t *ctx = malloc(sizeof(*ctx));
+    if (ctx == NULL) {
+        fprintf(stderr, "Error allocating search context\n");
+        exit(EXIT_FAILURE);
+    }
+
+    ctx->cells = cells;
+    ctx->gScore = NULL;
+    ctx->heap = NULL;
+    ctx->radix = NULL;
+    ctx->fromEnd = NULL;
+    ctx->backQueue.items = NULL;
+    ctx->parent = malloc((size_t)cells * sizeof(int));
+    ctx->stamp = calloc((size_t)cells, sizeof(uint32_t));
+    ctx->generation = 0;
+    ctx->queue.items = malloc((size_t)cells * sizeof(int));
+    ctx->queue.capacity = cells;
+    if (ctx->parent == NULL || ctx->stamp == NULL || ctx->queue.items == NULL) {
+        fprintf(stderr, "Error allocating search buffers for %d cells\n", cells);
+        exit(EXIT_FAILURE);
+    }
+
+    ResetSearchContext(ctx);
+    return ctx;
+}
+
+void FreeSearchContext(search_ctx_t *ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+
+    free(ctx->parent);
+    free(ctx->stamp);
+    free(ctx->queue.items);
+    free(ctx->gScore);
+    FreeHeap(ctx->heap);
+    FreeRadixHeap(ctx->radix);
+    free(ctx->fromEnd);
+    free(ctx->backQueue.items);
+    free(ctx);
+}
+
+/**
+ * @brief: Forgets every discovered cell so the context can run a new query.
+ *         Only when the generation wraps, once every 2^32 - 1 queries, are
+ *         the stamps actually cleared
+*/
+void ResetSearchContext(search_ctx_t *ctx) {
+    if (++ctx->generation == 0) {
+        memset(ctx->stamp, 0, (size_t)ctx->cells * sizeof(uint32_t));
+        ctx->generation = 1;
+    }
+    ctx->seenCount = 0;
+    ctx->queue.head = 0;
+    ctx->queue.count = 0;
+    ctx->expanded = 0;
+    ctx->revisits = 0;
+}
+
+void QueuePush(ring_queue_t *queue, int cell) {
+    int tail = queue->head + queue->count;
+    if (tail >= queue->capacity) {
+        tail -= queue->capacity;
+    }
+
+    queue->items[tail] = cell;
+    queue->count++;
+}
+
+int QueuePop(ring_queue_t *queue) {
+    int cell = queue->items[queue->head];
+
+    if (++queue->head == queue->capacity) {
+        queue->head = 0;
+    }
+    queue->count--;
+    return cell;
+}
+
+/**
+ * @brief: Allocates an empty heap for ids 0..capacity-1
+ * @return: Pointer to the new heap, exits on failure
+*/
+index_heap_t *CreateHeap(int capacity) {
+    index_heap_t *heap = malloc(sizeof(*heap));
+    if (heap == NULL) {
+        fprintf(stderr, "Error allocating heap\n");
+        exit(EXIT_FAILURE);
+    }
+
+    heap->items = malloc((size_t)capacity * sizeof(int));
+    heap->pos = malloc((size_t)capacity * sizeof(int));
+    heap->key = malloc((size_t)capacity * sizeof(uint64_t));
+    if (heap->items == NULL || heap->pos == NULL || heap->key == NULL) {
+        fprintf(stderr, "Error allocating heap for %d ids\n", capacity);
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < capacity; i++) {
+        heap->pos[i] = -1;
+    }
+    heap->size = 0;
+    heap->capacity = capacity;
+    return heap;
+}
+
+void FreeHeap(index_heap_t *heap) {
+    if (heap == NULL) {
+        return;
+    }
+
+    free(heap->items);
+    free(heap->pos);
+    free(heap->key);
+    free(heap);
+}
+
+static inline bool HeapLess(const index_heap_t *heap, int a, int b) {
+    return heap->key[a] < heap->key[b] ||
+           (heap->key[a] == heap->key[b] && a < b);
+}
+
+static inline void HeapPlace(index_heap_t *heap, int slot, int id) {
+    heap->items[slot] = id;
+    heap->pos[id] = slot;
+}
+
+static void HeapSiftUp(index_heap_t *heap, int slot) {
+    int id = heap->items[slot];
+
+    while (slot > 0) {
+        int parent = (slot - 1) / 2;
+        if (!HeapLess(heap, id, heap->items[parent])) {
+            break;
+        }
+        HeapPlace(heap, slot, heap->items[parent]);
+        slot = parent;
+    }
+    HeapPlace(heap, slot, id);
+}
+
+static void HeapSiftDown(index_heap_t *heap, int slot) {
+    int id = heap->items[slot];
+
+    for (;;) {
+        int child = 2 * slot + 1;
+        if (child >= heap->size) {
+            break;
+        }
+        if (child + 1 < heap->size &&
+            HeapLess(heap, heap->items[child + 1], heap->items[child])) {
+            child++;
+        }
+        if (!HeapLess(heap, heap->items[child], id)) {
+            break;
+        }
+        HeapPlace(heap, slot, heap->items[child]);
+        slot = child;
+    }
+    HeapPlace(heap, slot, id);
+}
+
+/**
+ * @brief: Inserts id with the given key, or moves it if already queued
+ *         (decrease-key and increase-key both go through here)
+*/
+void HeapPush(index_heap_t *heap, int id, uint64_t key) {
+    if (heap->pos[id] < 0) {
+        heap->key[id] = key;
+        HeapPlace(heap, heap->size++, id);
+        HeapSiftUp(heap, heap->size - 1);
+        return;
+    }
+
+    uint64_t old = heap->key[id];
+    heap->key[id] = key;
+    if (key < old) {
+        HeapSiftUp(heap, heap->pos[id]);
+    } else {
+        HeapSiftDown(heap, heap->pos[id]);
+    }
+}
+
+/**
+ * @brief: Removes the id with the smallest key
+ * @return: That id, -1 if the heap is empty
+*/
+int HeapPop(index_heap_t *heap) {
+    if (heap->size == 0) {
+        return -1;
+    }
+
+    int top = heap->items[0];
+    heap->pos[top] = -1;
+    if (--heap->size > 0) {
+        HeapPlace(heap, 0, heap->items[heap->size]);
+        HeapSiftDown(heap, 0);
+    }
+    return top;
+}
+
+void HeapRemove(index_heap_t *heap, int id) {
+    int slot = heap->pos[id];
+    if (slot < 0) {
+        return;
+    }
+
+    heap->pos[id] = -1;
+    if (slot == --heap->size) {
+        return;
+    }
+
+    int last = heap->items[heap->size];
+    HeapPlace(heap, slot, last);
+    HeapSiftUp(heap, slot);
+    HeapSiftDown(heap, heap->pos[last]);
+}
+
+/**
+ * @brief: Empties the heap in O(size) so it can be reused by another query
+*/
+void HeapClear(index_heap_t *heap) {
+    for (int i = 0; i < heap->size; i++) {
+        heap->pos[heap->items[i]] = -1;
+    }
+    heap->size = 0;
+}
+
+int ManhattanDistance(int row1, int col1, int row2, int col2) {
+    return abs(row1 - row2) + abs(col1 - col2);
+}
+
+static inline bool IsOpen(const map_t *map, int row, int col) {
+    return InBounds(map, row, col) && !IsBlocked(map, row, col);
+}
+
+static void EnsureScoreBuffer(search_ctx_t *ctx) {
+    if (ctx->gScore != NULL) {
+        return;
+    }
+
+    ctx->gScore = malloc((size_t)ctx->cells * sizeof(int));
+    if (ctx->gScore == NULL) {
+        fprintf(stderr, "Error allocating search scores\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void EnsureHeapBuffers(search_ctx_t *ctx) {
+    EnsureScoreBuffer(ctx);
+    if (ctx->heap == NULL) {
+        ctx->heap = CreateHeap(ctx->cells);
+    }
+}
+
+/**
+ * @brief: Breadth-first search from START to END without recursion
+ *         Each cell enters the ring queue at most once and records its
+ *         parent, so time and memory are O(cells); levels are counted by
+ *         draining the queue one distance layer at a time
+ * @return: Length of the shortest path in steps, -1 if END is unreachable
+*/
+int ShortestPath(const map_t *map, search_ctx_t *ctx, int startRow,
+                 int startColumn, int endRow, int endColumn) {
+    int startCell = CellId(map, startRow, startColumn);
+    int endCell = CellId(map, endRow, endColumn);
+
+    ResetSearchContext(ctx);
+    if (!MayReach(map, startRow, startColumn, endRow, endColumn)) {
+        return -1;
+    }
+    CtxMarkSeen(ctx, startCell, -1);
+    QueuePush(&ctx->queue, startCell);
+
+    for (int distance = 0; ctx->queue.count > 0; distance++) {
+        int layer = ctx->queue.count;
+
+        while (layer-- > 0) {
+            int cell = QueuePop(&ctx->queue);
+            ctx->expanded++;
+
+            if (cell == endCell) {
+                return distance;
+            }
+
+            int row = cell / map->cols;
+            int col = cell % map->cols;
+            for (int i = 0; i < 4; i++) {
+                int nextRow = row + rowDir[i];
+                int nextCol = col + colDir[i];
+                if (!InBounds(map, nextRow, nextCol) ||
+                    IsBlocked(map, nextRow, nextCol)) {
+                    continue;
+                }
+
+                int next = CellId(map, nextRow, nextCol);
+                if (!CtxSeen(ctx, next)) {
+                    CtxMarkSeen(ctx, next, cell);
+                    QueuePush(&ctx->queue, next);
+                } else {
+                    ctx->revisits++;
+                }
+            }
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief: A* search ordered by f = g + Manhattan distance to END
+ *         Ties on f go to the smaller h (closer to END), then to the
+ *         smaller cell id. The heuristic is consistent on a 4-connected
+ *         unit-cost grid, so a popped cell is final and never reopened
+ * @return: Length of the shortest path in steps, -1 if END is unreachable
+*/
+int AStarPath(const map_t *map, search_ctx_t *ctx, int startRow,
+              int startColumn, int endRow, int endColumn) {
+    EnsureHeapBuffers(ctx);
+
+    int startCell = CellId(map, startRow, startColumn);
+    int endCell = CellId(map, endRow, endColumn);
+    int result = -1;
+
+    ResetSearchContext(ctx);
+    HeapClear(ctx->heap);
+    if (!MayReach(map, startRow, startColumn, endRow, endColumn)) {
+        return -1;
+    }
+
+    int h = ManhattanDistance(startRow, startColumn, endRow, endColumn);
+    CtxMarkSeen(ctx, startCell, -1);
+    ctx->gScore[startCell] = 0;
+    HeapPush(ctx->heap, startCell, ((uint64_t)h << 32) | (uint32_t)h);
+
+    while (ctx->heap->size > 0) {
+        int cell = HeapPop(ctx->heap);
+        ctx->expanded++;
+
+        if (cell == endCell) {
+            result = ctx->gScore[cell];
+            break;
+        }
+
+        int row = cell / map->cols;
+        int col = cell % map->cols;
+        int nextG = ctx->gScore[cell] + 1;
+        for (int i = 0; i < 4; i++) {
+            int nextRow = row + rowDir[i];
+            int nextCol = col + colDir[i];
+            if (!InBounds(map, nextRow, nextCol) ||
+                IsBlocked(map, nextRow, nextCol)) {
+                continue;
+            }
+
+            int next = CellId(map, nextRow, nextCol);
+            bool fresh = !CtxSeen(ctx, next);
+            ctx->revisits += !fresh;
+            if (!fresh && (ctx->heap->pos[next] < 0 ||
+                           nextG >= ctx->gScore[next])) {
+                continue;
+            }
+
+            h = ManhattanDistance(nextRow, nextCol, endRow, endColumn);
+            CtxMarkSeen(ctx, next, cell);
+            ctx->gScore[next] = nextG;
+            HeapPush(ctx->heap, next,
+                     ((uint64_t)(nextG + h) << 32) | (uint32_t)h);
+        }
+    }
+
+    HeapClear(ctx->heap);
+    return result;
+}
+
+/**
+ * @brief: Slides along a row until a jump point: END, or a cell whose
+ *         up/down neighbour is open while the one behind it was blocked
+ * @return: Cell id of the jump point, -1 if a block or the edge comes first
+*/
+static int JumpHorizontal(const map_t *map, int row, int col, int colStep,
+                          int endRow, int endColumn) {
+    for (;;) {
+        int prevCol = col;
+        col += colStep;
+
+        if (!IsOpen(map, row, col)) {
+            return -1;
+        }
+        if (row == endRow && col == endColumn) {
+            return CellId(map, row, col);
+        }
+        if ((IsOpen(map, row - 1, col) && !IsOpen(map, row - 1, prevCol)) ||
+            (IsOpen(map, row + 1, col) && !IsOpen(map, row + 1, prevCol))) {
+            return CellId(map, row, col);
+        }
+    }
+}
+
+/**
+ * @brief: Slides along a column; besides END and forced neighbours, a cell
+ *         is a jump point when a horizontal scan from it finds one
+ * @return: Cell id of the jump point, -1 if a block or the edge comes first
+*/
+static int JumpVertical(const map_t *map, int row, int col, int rowStep,
+                        int endRow, int endColumn) {
+    for (;;) {
+        int prevRow = row;
+        row += rowStep;
+
+        if (!IsOpen(map, row, col)) {
+            return -1;
+        }
+        if (row == endRow && col == endColumn) {
+            return CellId(map, row, col);
+        }
+        if ((IsOpen(map, row, col - 1) && !IsOpen(map, prevRow, col - 1)) ||
+            (IsOpen(map, row, col + 1) && !IsOpen(map, prevRow, col + 1))) {
+            return CellId(map, row, col);
+        }
+        if (JumpHorizontal(map, row, col, 1, endRow, endColumn) >= 0 ||
+            JumpHorizontal(map, row, col, -1, endRow, endColumn) >= 0) {
+            return CellId(map, row, col);
+        }
+    }
+}
+
+/**
+ * @brief: Jump Point Search for the 4-connected, uniform-cost grid
+ *         Runs A* (same keys and tie-breaking as AStarPath) over jump
+ *         points only. A cell reached horizontally keeps going
+ *         horizontally or turns up/down; one reached vertically keeps
+ *         going vertically or turns left/right. Parent links join
+ *         collinear jump points, see MarkJumpPath
+ * @return: Length of the shortest path in steps, -1 if END is unreachable
+*/
+int JumpPointSearch(const map_t *map, search_ctx_t *ctx, int startRow,
+                    int startColumn, int endRow, int endColumn) {
+    EnsureHeapBuffers(ctx);
+
+    int startCell = CellId(map, startRow, startColumn);
+    int endCell = CellId(map, endRow, endColumn);
+    int result = -1;
+
+    ResetSearchContext(ctx);
+    HeapClear(ctx->heap);
+    if (!MayReach(map, startRow, startColumn, endRow, endColumn)) {
+        return -1;
+    }
+
+    int h = ManhattanDistance(startRow, startColumn, endRow, endColumn);
+    CtxMarkSeen(ctx, startCell, -1);
+    ctx->gScore[startCell] = 0;
+    HeapPush(ctx->heap, startCell, ((uint64_t)h << 32) | (uint32_t)h);
+
+    while (ctx->heap->size > 0) {
+        int cell = HeapPop(ctx->heap);
+        ctx->expanded++;
+
+        if (cell == endCell) {
+            result = ctx->gScore[cell];
+            break;
+        }
+
+        int row = cell / map->cols;
+        int col = cell % map->cols;
+        int parent = ctx->parent[cell];
+        int backRow = 0, backCol = 0;
+        if (parent >= 0) {
+            int parentRow = parent / map->cols, parentCol = parent % map->cols;
+            backRow = (parentRow > row) - (parentRow < row);
+            backCol = (parentCol > col) - (parentCol < col);
+        }
+
+        for (int i = 0; i < 4; i++) {
+            int jump;
+
+            /* Only the move back towards the parent is pruned */
+            if (rowDir[i] == backRow && colDir[i] == backCol) {
+                continue;
+            }
+
+            if (rowDir[i] != 0) {
+                jump = JumpVertical(map, row, col, rowDir[i], endRow, endColumn);
+            } else {
+                jump = JumpHorizontal(map, row, col, colDir[i], endRow, endColumn);
+            }
+            if (jump < 0) {
+                continue;
+            }
+
+            int jumpRow = jump / map->cols;
+            int jumpCol = jump % map->cols;
+            int nextG = ctx->gScore[cell] +
+                        ManhattanDistance(row, col, jumpRow, jumpCol);
+            bool fresh = !CtxSeen(ctx, jump);
+            ctx->revisits += !fresh;
+            if (!fresh && (ctx->heap->pos[jump] < 0 ||
+                           nextG >= ctx->gScore[jump])) {
+                continue;
+            }
+
+            h = ManhattanDistance(jumpRow, jumpCol, endRow, endColumn);
+            CtxMarkSeen(ctx, jump, cell);
+            ctx->gScore[jump] = nextG;
+            HeapPush(ctx->heap, jump,
+                     ((uint64_t)(nextG + h) << 32) | (uint32_t)h);
+        }
+    }
+
+    HeapClear(ctx->heap);
+    return result;
+}
+
+/**
+ * @brief: Like MarkSearchPath, but parent links join jump points, so each
+ *         straight segment between them is filled in cell by cell
+ * @return: Number of steps on the marked path
+*/
+int MarkJumpPath(map_t *map, const search_ctx_t *ctx, int endRow,
+                 int endColumn) {
+    int steps = 0;
+    int cell = CellId(map, endRow, endColumn);
+
+    while (ctx->parent[cell] >= 0) {
+        int parent = ctx->parent[cell];
+        int row = cell / map->cols, col = cell % map->cols;
+        int parentRow = parent / map->cols, parentCol = parent % map->cols;
+        int rowStep = (parentRow > row) - (parentRow < row);
+        int colStep = (parentCol > col) - (parentCol < col);
+
+        while (row != parentRow || col != parentCol) {
+            row += rowStep;
+            col += colStep;
+            steps++;
+            if (CellId(map, row, col) != parent || ctx->parent[parent] >= 0) {
+                SetPath(map, row, col);
+            }
+        }
+        cell = parent;
+    }
+
+    return steps;
+}
+
+/**
+ * @brief: Expands one whole BFS layer of one side of a bidirectional search
+ * @return: True once a neighbour owned by the other side is found; the
+ *          two touching cells are written to *near (this side) and *far
+*/
+static bool ExpandLayer(const map_t *map, search_ctx_t *ctx,
+                        ring_queue_t *queue, bool isEndSide,
+                        int *near, int *far) {
+    int layer = queue->count;
+
+    while (layer-- > 0) {
+        int cell = QueuePop(queue);
+        int row = cell / map->cols;
+        int col = cell % map->cols;
+        ctx->expanded++;
+
+        for (int i = 0; i < 4; i++) {
+            int nextRow = row + rowDir[i];
+            int nextCol = col + colDir[i];
+            if (!IsOpen(map, nextRow, nextCol)) {
+                continue;
+            }
+
+            int next = CellId(map, nextRow, nextCol);
+            if (!CtxSeen(ctx, next)) {
+                CtxMarkSeen(ctx, next, cell);
+                AssignBit(ctx->fromEnd, (size_t)next, isEndSide);
+                QueuePush(queue, next);
+            } else if (TestBit(ctx->fromEnd, (size_t)next) != isEndSide) {
+                *near = cell;
+                *far = next;
+                return true;
+            } else {
+                ctx->revisits++;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief: Breadth-first search grown from START and END at once, one full
+ *         layer at a time on whichever side has the smaller frontier.
+ *         Both sides share the seen stamps; fromEnd tells them apart. The
+ *         first edge joining the two sides lies on a shortest path, and
+ *         the END side's parent links are then reversed up to that edge so
+ *         MarkSearchPath can trace the whole path back to START
+ * @return: Length of the shortest path in steps, -1 if END is unreachable
+*/
+int BidirectionalPath(const map_t *map, search_ctx_t *ctx, int startRow,
+                      int startColumn, int endRow, int endColumn) {
+    size_t planeWords = ((size_t)ctx->cells + WORD_BITS - 1) / WORD_BITS;
+    if (ctx->fromEnd == NULL) {
+        ctx->fromEnd = malloc(planeWords * sizeof(uint64_t));
+        ctx->backQueue.items = malloc((size_t)ctx->cells * sizeof(int));
+        ctx->backQueue.capacity = ctx->cells;
+        if (ctx->fromEnd == NULL || ctx->backQueue.items == NULL) {
+            fprintf(stderr, "Error allocating bidirectional buffers\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int startCell = CellId(map, startRow, startColumn);
+    int endCell = CellId(map, endRow, endColumn);
+
+    ResetSearchContext(ctx);
+    ctx->backQueue.head = 0;
+    ctx->backQueue.count = 0;
+
+    if (!MayReach(map, startRow, startColumn, endRow, endColumn)) {
+        return -1;
+    }
+    if (startCell == endCell) {
+        CtxMarkSeen(ctx, startCell, -1);
+        return 0;
+    }
+
+    CtxMarkSeen(ctx, startCell, -1);
+    AssignBit(ctx->fromEnd, (size_t)startCell, false);
+    QueuePush(&ctx->queue, startCell);
+    CtxMarkSeen(ctx, endCell, -1);
+    AssignBit(ctx->fromEnd, (size_t)endCell, true);
+    QueuePush(&ctx->backQueue, endCell);
+
+    int startDepth = 0, endDepth = 0;
+    int near = -1, far = -1;
+    bool met = false;
+
+    while (!met && ctx->queue.count > 0 && ctx->backQueue.count > 0) {
+        if (ctx->queue.count <= ctx->backQueue.count) {
+            met = ExpandLayer(map, ctx, &ctx->queue, false, &near, &far);
+            startDepth++;
+        } else {
+            met = ExpandLayer(map, ctx, &ctx->backQueue, true, &near, &far);
+            endDepth++;
+        }
+    }
+
+    if (!met) {
+        return -1;
+    }
+
+    /* Orient the joining edge START side -> END side */
+    int startSide = TestBit(ctx->fromEnd, (size_t)near) ? far : near;
+    int endSide = (startSide == near) ? far : near;
+
+    /* Reverse END side links so every path cell points towards START */
+    int previous = startSide;
+    int cell = endSide;
+    while (cell >= 0) {
+        int next = ctx->parent[cell];
+        ctx->parent[cell] = previous;
+        previous = cell;
+        cell = next;
+    }
+
+    return startDepth + endDepth;
+}
+
+static inline uint64_t *BitsetRow(const bitset_bfs_t *bfs, uint64_t *plane,
+                                  int row) {
+    return plane + (size_t)(row + 1) * bfs->stride + 1;
+}
+
+/**
+ * @brief: Builds the open-cell bitset of a map plus empty BFS planes
+ * @return: Pointer to the new bitset BFS state, exits on failure
+*/
+bitset_bfs_t *CreateBitsetBfs(const map_t *map) {
+    bitset_bfs_t *bfs = malloc(sizeof(*bfs));
+    if (bfs == NULL) {
+        fprintf(stderr, "Error allocating bitset BFS\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bfs->rows = map->rows;
+    bfs->rowWords = map->rowWords;
+    bfs->stride = map->rowWords + 2;
+
+    size_t words = (size_t)(map->rows + 2) * bfs->stride;
+    bfs->open = calloc(words, sizeof(uint64_t));
+    bfs->reached = calloc(words, sizeof(uint64_t));
+    bfs->frontier = calloc(words, sizeof(uint64_t));
+    bfs->next = calloc(words, sizeof(uint64_t));
+    if (bfs->open == NULL || bfs->reached == NULL ||
+        bfs->frontier == NULL || bfs->next == NULL) {
+        fprintf(stderr, "Error allocating bitset BFS planes\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int tailBits = map->cols % WORD_BITS;
+    uint64_t tailMask = tailBits ? ((uint64_t)1 << tailBits) - 1 : ~(uint64_t)0;
+    for (int row = 0; row < map->rows; row++) {
+        uint64_t *open = BitsetRow(bfs, bfs->open, row);
+
+        if (map->layout == LAYOUT_ROWMAJOR) {
+            const uint64_t *blocked = map->blocked + (size_t)row * map->rowWords;
+            for (int w = 0; w < map->rowWords; w++) {
+                open[w] = ~blocked[w];
+            }
+            open[map->rowWords - 1] &= tailMask;
+        } else {
+            for (int col = 0; col < map->cols; col++) {
+                if (!IsBlocked(map, row, col)) {
+                    SetBit(open, (size_t)col);
+                }
+            }
+        }
+    }
+
+    return bfs;
+}
+
+void FreeBitsetBfs(bitset_bfs_t *bfs) {
+    if (bfs == NULL) {
+        return;
+    }
+
+    free(bfs->open);
+    free(bfs->reached);
+    free(bfs->frontier);
+    free(bfs->next);
+    free(bfs);
+}
+
+/**
+ * @brief: Grows one BFS layer for a single row, 64 cells per word: a cell
+ *         joins the layer if it is open, not yet reached, and a frontier
+ *         cell sits left, right, above or below it
+ * @return: Non-zero if any cell of this row joined the layer
+*/
+static uint64_t ExpandBitsetRow(const bitset_bfs_t *bfs, int row) {
+    const uint64_t *cur = BitsetRow(bfs, bfs->frontier, row);
+    const uint64_t *up = BitsetRow(bfs, bfs->frontier, row - 1);
+    const uint64_t *down = BitsetRow(bfs, bfs->frontier, row + 1);
+    const uint64_t *open = BitsetRow(bfs, bfs->open, row);
+    uint64_t *reached = BitsetRow(bfs, bfs->reached, row);
+    uint64_t *next = BitsetRow(bfs, bfs->next, row);
+    uint64_t any = 0;
+    int w = 0;
+
+#ifdef __AVX2__
+    __m256i anyVec = _mm256_setzero_si256();
+    for (; w + 4 <= bfs->rowWords; w += 4) {
+        __m256i mid = _mm256_loadu_si256((const __m256i *)(cur + w));
+        __m256i left = _mm256_loadu_si256((const __m256i *)(cur + w - 1));
+        __m256i right = _mm256_loadu_si256((const __m256i *)(cur + w + 1));
+        __m256i grow = _mm256_or_si256(_mm256_slli_epi64(mid, 1),
+                                       _mm256_srli_epi64(left, 63));
+        grow = _mm256_or_si256(grow, _mm256_srli_epi64(mid, 1));
+        grow = _mm256_or_si256(grow, _mm256_slli_epi64(right, 63));
+        grow = _mm256_or_si256(grow,
+                               _mm256_loadu_si256((const __m256i *)(up + w)));
+        grow = _mm256_or_si256(grow,
+                               _mm256_loadu_si256((const __m256i *)(down + w)));
+
+        __m256i seen = _mm256_loadu_si256((const __m256i *)(reached + w));
+        __m256i fresh = _mm256_andnot_si256(
+            seen, _mm256_and_si256(grow,
+                                   _mm256_loadu_si256((const __m256i *)(open + w))));
+        _mm256_storeu_si256((__m256i *)(next + w), fresh);
+        _mm256_storeu_si256((__m256i *)(reached + w), _mm256_or_si256(seen, fresh));
+        anyVec = _mm256_or_si256(anyVec, fresh);
+    }
+    any = !_mm256_testz_si256(anyVec, anyVec);
+#endif
+
+    for (; w < bfs->rowWords; w++) {
+        uint64_t grow = (cur[w] << 1) | (cur[w - 1] >> 63) |
+                        (cur[w] >> 1) | (cur[w + 1] << 63) | up[w] | down[w];
+        uint64_t fresh = grow & open[w] & ~reached[w];
+
+        next[w] = fresh;
+        reached[w] |= fresh;
+        any |= fresh;
+    }
+
+    return any;
+}
+
+/**
+ * @brief: Level-synchronous BFS on bitsets: each layer is built with
+ *         shifts, ORs and ANDs over whole words (4 words per instruction
+ *         when compiled with AVX2), and only the rows the frontier can
+ *         reach are swept. Answers reachability and distance, no path
+ * @return: Distance from START to END in steps, -1 if END is unreachable
+*/
+int BitsetDistance(bitset_bfs_t *bfs, int startRow, int startColumn,
+                   int endRow, int endColumn) {
+    size_t words = (size_t)(bfs->rows + 2) * bfs->stride;
+    memset(bfs->reached, 0, words * sizeof(uint64_t));
+    memset(bfs->frontier, 0, words * sizeof(uint64_t));
+    memset(bfs->next, 0, words * sizeof(uint64_t));
+
+    if (startRow == endRow && startColumn == endColumn) {
+        return 0;
+    }
+
+    SetBit(BitsetRow(bfs, bfs->frontier, startRow), (size_t)startColumn);
+    SetBit(BitsetRow(bfs, bfs->reached, startRow), (size_t)startColumn);
+
+    int low = startRow, high = startRow;
+    for (int distance = 1; low <= high; distance++) {
+        int from = (low > 0) ? low - 1 : 0;
+        int to = (high < bfs->rows - 1) ? high + 1 : bfs->rows - 1;
+
+        low = bfs->rows;
+        high = -1;
+        for (int row = from; row <= to; row++) {
+            if (ExpandBitsetRow(bfs, row)) {
+                if (row < low) {
+                    low = row;
+                }
+                high = row;
+            }
+        }
+
+        uint64_t *swap = bfs->frontier;
+        bfs->frontier = bfs->next;
+        bfs->next = swap;
+
+        if (TestBit(BitsetRow(bfs, bfs->frontier, endRow), (size_t)endColumn)) {
+            return distance;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief: Follows parent links back from END and marks PATH_SPACE on every
+ *         cell strictly between END and START
+ * @return: Number of steps on the marked path
+*/
+int MarkSearchPath(map_t *map, const search_ctx_t *ctx, int endRow,
+                   int endColumn) {
+    int steps = 0;
+    int cell = ctx->parent[CellId(map, endRow, endColumn)];
+
+    while (cell >= 0) {
+        steps++;
+        if (ctx->parent[cell] >= 0) {
+            SetPath(map, cell / map->cols, cell % map->cols);
+        }
+        cell = ctx->parent[cell];
+    }
+
+    return steps;
+}
+
+/**
+ * @brief: Copies every cell the last search discovered into the visited
+ *         plane so PrintMap shows the explored area as VISITED_SPACE
+*/
+void MarkSearchVisited(map_t *map, const search_ctx_t *ctx) {
+    for (int cell = 0; cell < ctx->cells; cell++) {
+        if (CtxSeen(ctx, cell)) {
+            SetVisited(map, cell / map->cols, cell % map->cols);
+        }
+    }
+}
+
+/*==========================================================*
+*                     WEIGHTED TERRAIN                      *
+*==========================================================*/
+static inline int CellCost(const map_t *map, int cell) {
+    return (map->costs != NULL) ? map->costs[cell] : 1;
+}
+
+radix_heap_t *CreateRadixHeap(void) {
+    radix_heap_t *heap = calloc(1, sizeof(*heap));
+    if (heap == NULL) {
+        fprintf(stderr, "Error allocating radix heap\n");
+        exit(EXIT_FAILURE);
+    }
+    return heap;
+}
+
+void FreeRadixHeap(radix_heap_t *heap) {
+    if (heap == NULL) {
+        return;
+    }
+
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        free(heap->items[b]);
+    }
+    free(heap);
+}
+
+static inline int RadixBucket(const radix_heap_t *heap, uint32_t key) {
+    return (key == heap->last) ? 0 : 32 - __builtin_clz(key ^ heap->last);
+}
+
+static void RadixAppend(radix_heap_t *heap, int bucket, radix_item_t item) {
+    if (heap->count[bucket] == heap->capacity[bucket]) {
+        int capacity = heap->capacity[bucket] ? 2 * heap->capacity[bucket] : 64;
+        radix_item_t *items = realloc(heap->items[bucket],
+                                      (size_t)capacity * sizeof(*items));
+        if (items == NULL) {
+            fprintf(stderr, "Error growing radix heap\n");
+            exit(EXIT_FAILURE);
+        }
+        heap->items[bucket] = items;
+        heap->capacity[bucket] = capacity;
+    }
+    heap->items[bucket][heap->count[bucket]++] = item;
+}
+
+/**
+ * @brief: Queues cell with priority key, which must not be smaller than
+ *         the key of the last pop
+*/
+void RadixPush(radix_heap_t *heap, uint32_t key, int cell) {
+    radix_item_t item = {key, cell};
+    RadixAppend(heap, RadixBucket(heap, key), item);
+    heap->size++;
+}
+
+/**
+ * @brief: Removes an item with the smallest key. When bucket 0 is empty
+ *         the first non-empty bucket is split around its minimum, which
+ *         sends every one of its items to a lower bucket
+ * @return: Cell of the item, with its key stored in *key
+*/
+int RadixPop(radix_heap_t *heap, uint32_t *key) {
+    if (heap->count[0] == 0) {
+        int b = 1;
+        while (heap->count[b] == 0) {
+            b++;
+        }
+
+        radix_item_t *items = heap->items[b];
+        int count = heap->count[b];
+        uint32_t least = items[0].key;
+        for (int i = 1; i < count; i++) {
+            if (items[i].key < least) {
+                least = items[i].key;
+            }
+        }
+
+        heap->last = least;
+        heap->count[b] = 0;
+        for (int i = 0; i < count; i++) {
+            RadixAppend(heap, RadixBucket(heap, items[i].key), items[i]);
+        }
+    }
+
+    radix_item_t item = heap->items[0][--heap->count[0]];
+    heap->size--;
+    *key = item.key;
+    return item.cell;
+}
+
+void RadixClear(radix_heap_t *heap) {
+    memset(heap->count, 0, sizeof(heap->count));
+    heap->last = 0;
+    heap->size = 0;
+}
+
+/**
+ * @brief: Dijkstra's search over the cost layer, where stepping into a
+ *         cell costs its entry (1 without a layer). Keys never drop below
+ *         the last popped distance, so a radix heap replaces the binary
+ *         heap; a cell improved twice stays queued twice and the stale
+ *         copy is skipped when its key no longer matches gScore
+ * @return: Cost of the cheapest path, -1 if END is unreachable
+*/
+int DijkstraPath(const map_t *map, search_ctx_t *ctx, int startRow,
+                 int startColumn, int endRow, int endColumn) {
+    if (ctx->radix == NULL) {
+        ctx->radix = CreateRadixHeap();
+    }
+    EnsureScoreBuffer(ctx);
+
+    int startCell = CellId(map, startRow, startColumn);
+    int endCell = CellId(map, endRow, endColumn);
+    int result = -1;
+
+    ResetSearchContext(ctx);
+    RadixClear(ctx->radix);
+    if (!MayReach(map, startRow, startColumn, endRow, endColumn)) {
+        return -1;
+    }
+
+    CtxMarkSeen(ctx, startCell, -1);
+    ctx->gScore[startCell] = 0;
+    RadixPush(ctx->radix, 0, startCell);
+
+    while (ctx->radix->size > 0) {
+        uint32_t key;
+        int cell = RadixPop(ctx->radix, &key);
+        if ((int)key != ctx->gScore[cell]) {
+            continue;
+        }
+        ctx->expanded++;
+
+        if (cell == endCell) {
+            result = ctx->gScore[cell];
+            break;
+        }
+
+        int row = cell / map->cols;
+        int col = cell % map->cols;
+        for (int i = 0; i < 4; i++) {
+            int nextRow = row + rowDir[i];
+            int nextCol = col + colDir[i];
+            if (!InBounds(map, nextRow, nextCol) ||
+                IsBlocked(map, nextRow, nextCol)) {
+                continue;
+            }
+
+            int next = CellId(map, nextRow, nextCol);
+            int nextG = ctx->gScore[cell] + CellCost(map, next);
+            bool fresh = !CtxSeen(ctx, next);
+            ctx->revisits += !fresh;
+            if (!fresh && nextG >= ctx->gScore[next]) {
+                continue;
+            }
+
+            CtxMarkSeen(ctx, next, cell);
+            ctx->gScore[next] = nextG;
+            RadixPush(ctx->radix, (uint32_t)nextG, next);
+        }
+    }
+
+    RadixClear(ctx->radix);
+    return result;
+}
+
+/**
+ * @brief: AStarPath over the cost layer. The heuristic is the Manhattan
+ *         distance times the cheapest entry cost, which stays consistent,
+ *         so a popped cell is still final
+ * @return: Cost of the cheapest path, -1 if END is unreachable
+*/
+int WeightedAStarPath(const map_t *map, search_ctx_t *ctx, int startRow,
+                      int startColumn, int endRow, int endColumn) {
+    EnsureHeapBuffers(ctx);
+
+    int startCell = CellId(map, startRow, startColumn);
+    int endCell = CellId(map, endRow, endColumn);
+    int result = -1;
+
+    ResetSearchContext(ctx);
+    HeapClear(ctx->heap);
+    if (!MayReach(map, startRow, startColumn, endRow, endColumn)) {
+        return -1;
+    }
+
+    int h = ManhattanDistance(startRow, startColumn, endRow, endColumn) *
+            map->minCost;
+    CtxMarkSeen(ctx, startCell, -1);
+    ctx->gScore[startCell] = 0;
+    HeapPush(ctx->heap, startCell, ((uint64_t)h << 32) | (uint32_t)h);
+
+    while (ctx->heap->size > 0) {
+        int cell = HeapPop(ctx->heap);
+        ctx->expanded++;
+
+        if (cell == endCell) {
+            result = ctx->gScore[cell];
+            break;
+        }
+
+        int row = cell / map->cols;
+        int col = cell % map->cols;
+        for (int i = 0; i < 4; i++) {
+            int nextRow = row + rowDir[i];
+            int nextCol = col + colDir[i];
+            if (!InBounds(map, nextRow, nextCol) ||
+                IsBlocked(map, nextRow, nextCol)) {
+                continue;
+            }
+
+            int next = CellId(map, nextRow, nextCol);
+            int nextG = ctx->gScore[cell] + CellCost(map, next);
+            bool fresh = !CtxSeen(ctx, next);
+            ctx->revisits += !fresh;
+            if (!fresh && (ctx->heap->pos[next] < 0 ||
+                           nextG >= ctx->gScore[next])) {
+                continue;
+            }
+
+            CtxMarkSeen(ctx, next, cell);
+            ctx->gScore[next] = nextG;
+            h = ManhattanDistance(nextRow, nextCol, endRow, endColumn) *
+                map->minCost;
+            HeapPush(ctx->heap, next,
+                     ((uint64_t)(nextG + h) << 32) | (uint32_t)h);
+        }
+    }
+
+    HeapClear(ctx->heap);
+    return result;
+}
+
+/*==========================================================*
+*                      COMPONENT INDEX                      *
+*==========================================================*/
+/**
+ * @brief: Gives every open cell reachable from seed the label newLabel,
+ *         walking only through cells that currently carry oldLabel
+*/
+static void FloodComponent(const map_t *map, components_t *components,
+                           int seed, int oldLabel, int newLabel) {
+    ring_queue_t *queue = &components->queue;
+
+    queue->head = 0;
+    queue->count = 0;
+    components->label[seed] = newLabel;
+    QueuePush(queue, seed);
+
+    while (queue->count > 0) {
+        int cell = QueuePop(queue);
+        int row = cell / map->cols;
+        int col = cell % map->cols;
+
+        for (int i = 0; i < 4; i++) {
+            int nextRow = row + rowDir[i];
+            int nextCol = col + colDir[i];
+            if (!InBounds(map, nextRow, nextCol)) {
+                continue;
+            }
+
+            int next = CellId(map, nextRow, nextCol);
+            if (components->label[next] == oldLabel &&
+                !IsBlocked(map, nextRow, nextCol)) {
+                components->label[next] = newLabel;
+                QueuePush(queue, next);
+            }
+        }
+    }
+}
+
+/**
+ * @brief: Labels the connected components of the open cells, one flood
+ *         fill per component, O(cells) in total
+ * @return: Pointer to the new index, exits on failure
+*/
+components_t *BuildComponents(const map_t *map) {
+    int cells = map->rows * map->cols;
+    components_t *components = malloc(sizeof(*components));
+    if (components == NULL) {
+        fprintf(stderr, "Error allocating component index\n");
+        exit(EXIT_FAILURE);
+    }
+
+    components->label = calloc((size_t)cells, sizeof(int));
+    components->queue.items = malloc((size_t)cells * sizeof(int));
+    components->queue.capacity = cells;
+    if (components->label == NULL || components->queue.items == NULL) {
+        fprintf(stderr, "Error allocating component labels\n");
+        exit(EXIT_FAILURE);
+    }
+
+    components->nextLabel = 1;
+    for (int row = 0; row < map->rows; row++) {
+        for (int col = 0; col < map->cols; col++) {
+            int cell = CellId(map, row, col);
+            if (components->label[cell] == 0 && !IsBlocked(map, row, col)) {
+                FloodComponent(map, components, cell, 0,
+                               components->nextLabel++);
+            }
+        }
+    }
+
+    return components;
+}
+
+void FreeComponents(components_t *components) {
+    if (components == NULL) {
+        return;
+    }
+
+    free(components->label);
+    free(components->queue.items);
+    free(components);
+}
+
+/**
+ * @brief: O(1) connectivity test against the map's component index
+ * @return: False only if an index exists and the two cells are in
+ *          different components (or either is blocked), true otherwise
+*/
+bool MayReach(const map_t *map, int startRow, int startColumn, int endRow,
+              int endColumn) {
+    if (map->components == NULL) {
+        return true;
+    }
+
+    int startLabel = map->components->label[CellId(map, startRow, startColumn)];
+    int endLabel = map->components->label[CellId(map, endRow, endColumn)];
+    return startLabel != 0 && startLabel == endLabel;
+}
+
+/**
+ * @brief: Blocks one cell and keeps the component index up to date. If the
+ *         open 4-neighbours of the cell still touch through the ring of 8
+ *         cells around it, the component cannot split and nothing else
+ *         changes; otherwise each side is flood-filled with a fresh label,
+ *         costing O(size of the old component)
+*/
+void AddBlock(map_t *map, int row, int col) {
+    static const int ringRow[8] = {-1, -1, -1, 0, 1, 1, 1, 0};
+    static const int ringCol[8] = {-1, 0, 1, 1, 1, 0, -1, -1};
+
+    if (!InBounds(map, row, col) || IsBlocked(map, row, col)) {
+        return;
+    }
+
+    SetBlocked(map, row, col);
+    components_t *components = map->components;
+    if (components == NULL) {
+        return;
+    }
+
+    int cell = CellId(map, row, col);
+    int oldLabel = components->label[cell];
+    components->label[cell] = 0;
+
+    /* Count runs of open ring cells that contain a 4-neighbour (odd slot) */
+    bool open[8];
+    int firstClosed = -1;
+    for (int i = 0; i < 8; i++) {
+        open[i] = IsOpen(map, row + ringRow[i], col + ringCol[i]);
+        if (!open[i] && firstClosed < 0) {
+            firstClosed = i;
+        }
+    }
+    if (firstClosed < 0) {
+        return;
+    }
+
+    int runs = 0;
+    bool runHasNeighbour = false;
+    for (int k = 1; k <= 8; k++) {
+        int i = (firstClosed + k) % 8;
+        if (open[i]) {
+            runHasNeighbour |= (i % 2 == 1);
+        } else {
+            runs += runHasNeighbour;
+            runHasNeighbour = false;
+        }
+    }
+    if (runs <= 1) {
+        return;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        int nextRow = row + rowDir[i];
+        int nextCol = col + colDir[i];
+        if (IsOpen(map, nextRow, nextCol) &&
+            components->label[CellId(map, nextRow, nextCol)] == oldLabel) {
+            FloodComponent(map, components, CellId(map, nextRow, nextCol),
+                           oldLabel, components->nextLabel++);
+        }
+    }
+}
+
+/**
+ * @brief: Opens one cell and keeps the component index up to date by
+ *         merging every component that touches it into one label
+*/
+void RemoveBlock(map_t *map, int row, int col) {
+    if (!InBounds(map, row, col) || !IsBlocked(map, row, col)) {
+        return;
+    }
+
+    ClearBlocked(map, row, col);
+    components_t *components = map->components;
+    if (components == NULL) {
+        return;
+    }
+
+    int cell = CellId(map, row, col);
+    int merged = 0;
+    for (int i = 0; i < 4; i++) {
+        int nextRow = row + rowDir[i];
+        int nextCol = col + colDir[i];
+        if (!IsOpen(map, nextRow, nextCol)) {
+            continue;
+        }
+
+        int next = CellId(map, nextRow, nextCol);
+        if (merged == 0) {
+            merged = components->label[next];
+        } else if (components->label[next] != merged) {
+            FloodComponent(map, components, next, components->label[next],
+                           merged);
+        }
+    }
+
+    components->label[cell] = (merged != 0) ? merged : components->nextLabel++;
+}
+
+/*==========================================================*
+*                  INCREMENTAL REPLANNING                   *
+*==========================================================*/
+static inline uint64_t DStarKey(const dstar_t *dstar, int cell) {
+    const map_t *map = dstar->map;
+    int best = (dstar->g[cell] < dstar->rhs[cell]) ? dstar->g[cell]
+                                                   : dstar->rhs[cell];
+    int h = ManhattanDistance(cell / map->cols, cell % map->cols,
+                              dstar->start / map->cols,
+                              dstar->start % map->cols);
+
+    return ((uint64_t)(best + h) << 32) | (uint32_t)best;
+}
+
+/**
+ * @brief: Recomputes rhs of a cell from its neighbours' g and puts it on
+ *         (or takes it off) the open list depending on whether g == rhs
+*/
+static void DStarUpdateCell(dstar_t *dstar, int cell) {
+    const map_t *map = dstar->map;
+    int row = cell / map->cols;
+    int col = cell % map->cols;
+
+    if (cell != dstar->goal) {
+        int best = UNREACHABLE;
+        if (!IsBlocked(map, row, col)) {
+            for (int i = 0; i < 4; i++) {
+                int nextRow = row + rowDir[i];
+                int nextCol = col + colDir[i];
+                if (IsOpen(map, nextRow, nextCol)) {
+                    int next = CellId(map, nextRow, nextCol);
+                    if (dstar->g[next] + 1 < best) {
+                        best = dstar->g[next] + 1;
+                    }
+                }
+            }
+        }
+        dstar->rhs[cell] = best;
+    }
+
+    if (dstar->g[cell] != dstar->rhs[cell]) {
+        HeapPush(dstar->open, cell, DStarKey(dstar, cell));
+    } else {
+        HeapRemove(dstar->open, cell);
+    }
+}
+
+static void DStarUpdateAround(dstar_t *dstar, int cell) {
+    const map_t *map = dstar->map;
+    int row = cell / map->cols;
+    int col = cell % map->cols;
+
+    for (int i = 0; i < 4; i++) {
+        if (InBounds(map, row + rowDir[i], col + colDir[i])) {
+            DStarUpdateCell(dstar, CellId(map, row + rowDir[i], col + colDir[i]));
+        }
+    }
+}
+
+/**
+ * @brief: Sets up D* Lite for one START/END pair: every cell starts
+ *         unreachable and only END is on the open list
+ * @return: Pointer to the new planner, exits on failure
+*/
+dstar_t *CreateDStar(map_t *map, int startRow, int startColumn, int endRow,
+                     int endColumn) {
+    int cells = map->rows * map->cols;
+    dstar_t *dstar = malloc(sizeof(*dstar));
+    if (dstar == NULL) {
+        fprintf(stderr, "Error allocating D* Lite planner\n");
+        exit(EXIT_FAILURE);
+    }
+
+    dstar->map = map;
+    dstar->start = CellId(map, startRow, startColumn);
+    dstar->goal = CellId(map, endRow, endColumn);
+    dstar->g = malloc((size_t)cells * sizeof(int));
+    dstar->rhs = malloc((size_t)cells * sizeof(int));
+    dstar->open = CreateHeap(cells);
+    dstar->expanded = 0;
+    if (dstar->g == NULL || dstar->rhs == NULL) {
+        fprintf(stderr, "Error allocating D* Lite buffers\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < cells; i++) {
+        dstar->g[i] = dstar->rhs[i] = UNREACHABLE;
+    }
+    dstar->rhs[dstar->goal] = 0;
+    HeapPush(dstar->open, dstar->goal, DStarKey(dstar, dstar->goal));
+    return dstar;
+}
+
+void FreeDStar(dstar_t *dstar) {
+    if (dstar == NULL) {
+        return;
+    }
+
+    free(dstar->g);
+    free(dstar->rhs);
+    FreeHeap(dstar->open);
+    free(dstar);
+}
+
+/**
+ * @brief: D* Lite ComputeShortestPath. The first call is a backward A*
+ *         from END; later calls only revisit cells whose distance was
+ *         invalidated by DStarSetBlocked, so the work follows the change
+ * @return: Length of the shortest path in steps, -1 if END is unreachable
+*/
+int DStarPlan(dstar_t *dstar) {
+    index_heap_t *open = dstar->open;
+    int start = dstar->start;
+
+    dstar->expanded = 0;
+    while (open->size > 0 &&
+           (open->key[open->items[0]] < DStarKey(dstar, start) ||
+            dstar->rhs[start] != dstar->g[start])) {
+        int cell = open->items[0];
+        uint64_t oldKey = open->key[cell];
+        uint64_t newKey = DStarKey(dstar, cell);
+
+        dstar->expanded++;
+        if (oldKey < newKey) {
+            HeapPush(open, cell, newKey);
+        } else if (dstar->g[cell] > dstar->rhs[cell]) {
+            dstar->g[cell] = dstar->rhs[cell];
+            HeapPop(open);
+            DStarUpdateAround(dstar, cell);
+        } else {
+            dstar->g[cell] = UNREACHABLE;
+            DStarUpdateCell(dstar, cell);
+            DStarUpdateAround(dstar, cell);
+        }
+    }
+
+    return (dstar->rhs[start] >= UNREACHABLE) ? -1 : dstar->rhs[start];
+}
+
+/**
+ * @brief: Applies a block add/remove event to the map and tells D* Lite
+ *         which cells' costs changed (the cell and its 4 neighbours).
+ *         START and END are never blocked
+*/
+void DStarSetBlocked(dstar_t *dstar, int row, int col, bool blocked) {
+    map_t *map = dstar->map;
+
+    if (!InBounds(map, row, col) || IsBlocked(map, row, col) == blocked) {
+        return;
+    }
+
+    int cell = CellId(map, row, col);
+    if (cell == dstar->start || cell == dstar->goal) {
+        return;
+    }
+
+    if (blocked) {
+        AddBlock(map, row, col);
+    } else {
+        RemoveBlock(map, row, col);
+    }
+    DStarUpdateCell(dstar, cell);
+    DStarUpdateAround(dstar, cell);
+}
+
+/**
+ * @brief: Walks from START down the g gradient to END, marking PATH_SPACE
+ * @return: Number of steps on the marked path, -1 if there is none
+*/
+int MarkDStarPath(map_t *map, const dstar_t *dstar) {
+    int cell = dstar->start;
+    int steps = 0;
+
+    if (dstar->g[cell] >= UNREACHABLE) {
+        return -1;
+    }
+
+    while (cell != dstar->goal) {
+        int row = cell / map->cols;
+        int col = cell % map->cols;
+        int best = -1;
+
+        for (int i = 0; i < 4; i++) {
+            int nextRow = row + rowDir[i];
+            int nextCol = col + colDir[i];
+            if (IsOpen(map, nextRow, nextCol)) {
+                int next = CellId(map, nextRow, nextCol);
+                if (best < 0 || dstar->g[next] < dstar->g[best]) {
+                    best = next;
+                }
+            }
+        }
+
+        if (best < 0 || dstar->g[best] >= dstar->g[cell]) {
+            return -1;
+        }
+        cell = best;
+        steps++;
+        if (cell != dstar->goal) {
+            SetPath(map, cell / map->cols, cell % map->cols);
+        }
+    }
+
+    return steps;
+}
+
+/*==========================================================*
+*                 HIERARCHICAL PATHFINDING                  *
+*==========================================================*/
+static inline int ClusterOf(const hpa_t *hpa, int cell) {
+    int row = cell / hpa->map->cols;
+    int col = cell % hpa->map->cols;
+    return (row / CLUSTER_SIZE) * hpa->clusterCols + col / CLUSTER_SIZE;
+}
+
+static void ListPush(int_list_t *list, int value) {
+    if (list->count == list->capacity) {
+        list->capacity = (list->capacity > 0) ? 2 * list->capacity : 8;
+        list->items = realloc(list->items, (size_t)list->capacity * sizeof(int));
+        if (list->items == NULL) {
+            fprintf(stderr, "Error growing list to %d items\n", list->capacity);
+            exit(EXIT_FAILURE);
+        }
+    }
+    list->items[list->count++] = value;
+}
+
+/**
+ * @brief: Takes a node off the free list, or grows the node array
+ * @return: Id of an empty node
+*/
+static int NewHpaNode(hpa_t *hpa, int cell) {
+    int id;
+
+    if (hpa->freeNodes.count > 0) {
+        id = hpa->freeNodes.items[--hpa->freeNodes.count];
+    } else {
+        if (hpa->nodeCount == hpa->nodeCapacity) {
+            hpa->nodeCapacity = (hpa->nodeCapacity > 0) ? 2 * hpa->nodeCapacity
+                                                        : 64;
+            hpa->nodes = realloc(hpa->nodes,
+                                 (size_t)hpa->nodeCapacity * sizeof(hpa_node_t));
+            if (hpa->nodes == NULL) {
+                fprintf(stderr, "Error growing abstract graph\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        id = hpa->nodeCount++;
+        hpa->nodes[id].edges.items = NULL;
+        hpa->nodes[id].edges.capacity = 0;
+        hpa->nodes[id].costs.items = NULL;
+        hpa->nodes[id].costs.capacity = 0;
+    }
+
+    hpa_node_t *node = &hpa->nodes[id];
+    node->cell = cell;
+    node->cluster = ClusterOf(hpa, cell);
+    node->partner = -1;
+    node->edges.count = 0;
+    node->costs.count = 0;
+    node->goalCost = -1;
+    node->alive = true;
+    return id;
+}
+
+/**
+ * @brief: Breadth-first search confined to one cluster. Fills localDist
+ *         (-1 if unreached) and localParent, both indexed by the cell's
+ *         offset inside the cluster
+*/
+static void LocalBfs(hpa_t *hpa, int cluster, int source) {
+    const map_t *map = hpa->map;
+    int top = (cluster / hpa->clusterCols) * CLUSTER_SIZE;
+    int left = (cluster % hpa->clusterCols) * CLUSTER_SIZE;
+    int bottom = (top + CLUSTER_SIZE < map->rows) ? top + CLUSTER_SIZE : map->rows;
+    int right = (left + CLUSTER_SIZE < map->cols) ? left + CLUSTER_SIZE : map->cols;
+    int head = 0, tail = 0;
+
+    for (int i = 0; i < CLUSTER_SIZE * CLUSTER_SIZE; i++) {
+        hpa->localDist[i] = -1;
+    }
+
+    int first = (source / map->cols - top) * CLUSTER_SIZE + source % map->cols - left;
+    hpa->localDist[first] = 0;
+    hpa->localParent[first] = -1;
+    hpa->localQueue[tail++] = first;
+
+    while (head < tail) {
+        int local = hpa->localQueue[head++];
+        int row = top + local / CLUSTER_SIZE;
+        int col = left + local % CLUSTER_SIZE;
+
+        for (int i = 0; i < 4; i++) {
+            int nextRow = row + rowDir[i];
+            int nextCol = col + colDir[i];
+            if (nextRow < top || nextRow >= bottom || nextCol < left ||
+                nextCol >= right || IsBlocked(map, nextRow, nextCol)) {
+                continue;
+            }
+
+            int next = (nextRow - top) * CLUSTER_SIZE + nextCol - left;
+            if (hpa->localDist[next] < 0) {
+                hpa->localDist[next] = hpa->localDist[local] + 1;
+                hpa->localParent[next] = local;
+                hpa->localQueue[tail++] = next;
+            }
+        }
+    }
+}
+
+static inline int LocalIndex(const hpa_t *hpa, int cluster, int cell) {
+    int top = (cluster / hpa->clusterCols) * CLUSTER_SIZE;
+    int left = (cluster % hpa->clusterCols) * CLUSTER_SIZE;
+    return (cell / hpa->map->cols - top) * CLUSTER_SIZE +
+           cell % hpa->map->cols - left;
+}
+
+/**
+ * @brief: Recreates the entrances on one border between two clusters:
+ *         every maximal run of open cell pairs across the border gets one
+ *         transition in its middle, or one at each end if the run is at
+ *         least HPA_WIDE_ENTRANCE long. Old nodes of the border are freed
+ *         @param border: 2 * cluster for the right border of cluster,
+ *                        2 * cluster + 1 for its bottom border
+*/
+static void BuildBorder(hpa_t *hpa, int border) {
+    const map_t *map = hpa->map;
+    int_list_t *nodes = &hpa->borders[border];
+    int cluster = border / 2;
+    bool bottom = (border % 2 == 1);
+    int top = (cluster / hpa->clusterCols) * CLUSTER_SIZE;
+    int left = (cluster % hpa->clusterCols) * CLUSTER_SIZE;
+
+    for (int i = 0; i < nodes->count; i++) {
+        hpa->nodes[nodes->items[i]].alive = false;
+        ListPush(&hpa->freeNodes, nodes->items[i]);
+    }
+    nodes->count = 0;
+
+    /* Walk along the border; (row, col) is inside cluster, the partner
+     * cell is one step right (or down) in the neighbouring cluster */
+    int length = bottom ? ((left + CLUSTER_SIZE < map->cols) ? CLUSTER_SIZE
+                                                             : map->cols - left)
+                        : ((top + CLUSTER_SIZE < map->rows) ? CLUSTER_SIZE
+                                                            : map->rows - top);
+    int runStart = -1;
+    for (int i = 0; i <= length; i++) {
+        int row = bottom ? top + CLUSTER_SIZE - 1 : top + i;
+        int col = bottom ? left + i : left + CLUSTER_SIZE - 1;
+        bool open = (i < length) && IsOpen(map, row, col) &&
+                    IsOpen(map, row + bottom, col + !bottom);
+
+        if (open && runStart < 0) {
+            runStart = i;
+        }
+        if (open || runStart < 0) {
+            continue;
+        }
+
+        int runEnd = i - 1;
+        int picks[2] = {(runStart + runEnd) / 2, -1};
+        if (runEnd - runStart + 1 >= HPA_WIDE_ENTRANCE) {
+            picks[0] = runStart;
+            picks[1] = runEnd;
+        }
+        for (int k = 0; k < 2 && picks[k] >= 0; k++) {
+            int pickRow = bottom ? row : top + picks[k];
+            int pickCol = bottom ? left + picks[k] : col;
+            int inside = NewHpaNode(hpa, CellId(map, pickRow, pickCol));
+            int outside = NewHpaNode(hpa, CellId(map, pickRow + bottom,
+                                                 pickCol + !bottom));
+
+            hpa->nodes[inside].partner = outside;
+            hpa->nodes[outside].partner = inside;
+            ListPush(nodes, inside);
+            ListPush(nodes, outside);
+        }
+        runStart = -1;
+    }
+}
+
+/**
+ * @brief: Gathers the live nodes lying inside a cluster from the up to
+ *         four borders it shares with its neighbours
+*/
+static void CollectClusterNodes(hpa_t *hpa, int cluster, int_list_t *out) {
+    int clusterRow = cluster / hpa->clusterCols;
+    int clusterCol = cluster % hpa->clusterCols;
+    int borders[4] = {2 * cluster, 2 * cluster + 1, -1, -1};
+
+    if (clusterCol > 0) {
+        borders[2] = 2 * (cluster - 1);
+    }
+    if (clusterRow > 0) {
+        borders[3] = 2 * (cluster - hpa->clusterCols) + 1;
+    }
+
+    out->count = 0;
+    for (int b = 0; b < 4; b++) {
+        if (borders[b] < 0) {
+            continue;
+        }
+        const int_list_t *nodes = &hpa->borders[borders[b]];
+        for (int i = 0; i < nodes->count; i++) {
+            if (hpa->nodes[nodes->items[i]].cluster == cluster) {
+                ListPush(out, nodes->items[i]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief: Recomputes the cached in-cluster distances between every pair
+ *         of entrance nodes of one cluster, one local BFS per node
+*/
+static void BuildIntraEdges(hpa_t *hpa, int cluster) {
+    int_list_t *members = &hpa->scratch;
+
+    CollectClusterNodes(hpa, cluster, members);
+    for (int i = 0; i < members->count; i++) {
+        hpa_node_t *node = &hpa->nodes[members->items[i]];
+
+        node->edges.count = 0;
+        node->costs.count = 0;
+        LocalBfs(hpa, cluster, node->cell);
+        for (int j = 0; j < members->count; j++) {
+            int other = members->items[j];
+            int dist = hpa->localDist[LocalIndex(hpa, cluster,
+                                                 hpa->nodes[other].cell)];
+            if (j != i && dist >= 0) {
+                ListPush(&node->edges, other);
+                ListPush(&node->costs, dist);
+            }
+        }
+    }
+}
+
+/**
+ * @brief: Splits the map into CLUSTER_SIZE x CLUSTER_SIZE clusters, places
+ *         entrance nodes on every border and caches intra-cluster distances
+ * @return: Pointer to the new abstract graph, exits on failure
+*/
+hpa_t *BuildHierarchy(map_t *map) {
+    hpa_t *hpa = calloc(1, sizeof(*hpa));
+    if (hpa == NULL) {
+        fprintf(stderr, "Error allocating hierarchy\n");
+        exit(EXIT_FAILURE);
+    }
+
+    hpa->map = map;
+    hpa->clusterRows = (map->rows + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    hpa->clusterCols = (map->cols + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+    int clusters = hpa->clusterRows * hpa->clusterCols;
+
+    hpa->borders = calloc(2 * (size_t)clusters, sizeof(int_list_t));
+    hpa->localDist = malloc(CLUSTER_SIZE * CLUSTER_SIZE * sizeof(int));
+    hpa->localParent = malloc(CLUSTER_SIZE * CLUSTER_SIZE * sizeof(int));
+    hpa->localQueue = malloc(CLUSTER_SIZE * CLUSTER_SIZE * sizeof(int));
+    if (hpa->borders == NULL || hpa->localDist == NULL ||
+        hpa->localParent == NULL || hpa->localQueue == NULL) {
+        fprintf(stderr, "Error allocating hierarchy buffers\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int cluster = 0; cluster < clusters; cluster++) {
+        if (cluster % hpa->clusterCols + 1 < hpa->clusterCols) {
+            BuildBorder(hpa, 2 * cluster);
+        }
+        if (cluster / hpa->clusterCols + 1 < hpa->clusterRows) {
+            BuildBorder(hpa, 2 * cluster + 1);
+        }
+    }
+    for (int cluster = 0; cluster < clusters; cluster++) {
+        BuildIntraEdges(hpa, cluster);
+    }
+
+    return hpa;
+}
+
+void FreeHierarchy(hpa_t *hpa) {
+    if (hpa == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < hpa->nodeCount; i++) {
+        free(hpa->nodes[i].edges.items);
+        free(hpa->nodes[i].costs.items);
+    }
+    for (int i = 0; i < 2 * hpa->clusterRows * hpa->clusterCols; i++) {
+        free(hpa->borders[i].items);
+    }
+    free(hpa->nodes);
+    free(hpa->borders);
+    free(hpa->freeNodes.items);
+    free(hpa->scratch.items);
+    free(hpa->localDist);
+    free(hpa->localParent);
+    free(hpa->localQueue);
+    free(hpa->g);
+    free(hpa->parent);
+    FreeHeap(hpa->open);
+    free(hpa);
+}
+
+/**
+ * @brief: Call after a cell is blocked or opened. Only the cluster holding
+ *         the cell has its distances recomputed, plus the neighbour across
+ *         a border the cell lies on, since that border's entrances change
+*/
+void HierarchyCellChanged(hpa_t *hpa, int row, int col) {
+    int cluster = ClusterOf(hpa, CellId(hpa->map, row, col));
+    int clusterRow = cluster / hpa->clusterCols;
+    int clusterCol = cluster % hpa->clusterCols;
+    int localRow = row % CLUSTER_SIZE;
+    int localCol = col % CLUSTER_SIZE;
+    int dirty[5] = {cluster, -1, -1, -1, -1};
+
+    if (localCol == CLUSTER_SIZE - 1 && clusterCol + 1 < hpa->clusterCols) {
+        BuildBorder(hpa, 2 * cluster);
+        dirty[1] = cluster + 1;
+    }
+    if (localCol == 0 && clusterCol > 0) {
+        BuildBorder(hpa, 2 * (cluster - 1));
+        dirty[2] = cluster - 1;
+    }
+    if (localRow == CLUSTER_SIZE - 1 && clusterRow + 1 < hpa->clusterRows) {
+        BuildBorder(hpa, 2 * cluster + 1);
+        dirty[3] = cluster + hpa->clusterCols;
+    }
+    if (localRow == 0 && clusterRow > 0) {
+        BuildBorder(hpa, 2 * (cluster - hpa->clusterCols) + 1);
+        dirty[4] = cluster - hpa->clusterCols;
+    }
+
+    for (int i = 0; i < 5; i++) {
+        if (dirty[i] >= 0) {
+            BuildIntraEdges(hpa, dirty[i]);
+        }
+    }
+}
+
+/**
+ * @brief: Marks the cells of the in-cluster shortest path from one cell to
+ *         another (excluding START/END, which keep their own symbols)
+*/
+static void RefineSegment(hpa_t *hpa, int from, int to) {
+    map_t *map = hpa->map;
+    int cluster = ClusterOf(hpa, from);
+
+    if (from == to) {
+        return;
+    }
+    if (ClusterOf(hpa, to) != cluster) {
+        SetPath(map, to / map->cols, to % map->cols);
+        return;
+    }
+
+    LocalBfs(hpa, cluster, from);
+    int top = (cluster / hpa->clusterCols) * CLUSTER_SIZE;
+    int left = (cluster % hpa->clusterCols) * CLUSTER_SIZE;
+    for (int local = LocalIndex(hpa, cluster, to); local >= 0;
+         local = hpa->localParent[local]) {
+        SetPath(map, top + local / CLUSTER_SIZE, left + local % CLUSTER_SIZE);
+    }
+}
+
+/**
+ * @brief: HPA* query. START and END are linked to the entrances of their
+ *         own clusters by local BFS, the abstract graph is searched with
+ *         A* (Manhattan heuristic), and with mark set each abstract edge
+ *         is refined back into grid cells and marked as PATH_SPACE.
+ *         Paths are optimal on the abstract graph, so they may be a few
+ *         steps longer than the true shortest path
+ * @return: Length of the path found in steps, -1 if END is unreachable
+*/
+int HierarchicalPath(hpa_t *hpa, int startRow, int startColumn, int endRow,
+                     int endColumn, bool mark) {
+    map_t *map = hpa->map;
+    int start = CellId(map, startRow, startColumn);
+    int end = CellId(map, endRow, endColumn);
+    int startCluster = ClusterOf(hpa, start);
+    int endCluster = ClusterOf(hpa, end);
+
+    hpa->expanded = 0;
+    if (start == end) {
+        return 0;
+    }
+    if (!MayReach(map, startRow, startColumn, endRow, endColumn)) {
+        return -1;
+    }
+
+    /* One extra id stands for END itself */
+    int goal = hpa->nodeCount;
+    if (hpa->searchCapacity < hpa->nodeCount + 1) {
+        hpa->searchCapacity = hpa->nodeCapacity + 1;
+        free(hpa->g);
+        free(hpa->parent);
+        FreeHeap(hpa->open);
+        hpa->g = malloc((size_t)hpa->searchCapacity * sizeof(int));
+        hpa->parent = malloc((size_t)hpa->searchCapacity * sizeof(int));
+        hpa->open = CreateHeap(hpa->searchCapacity);
+        if (hpa->g == NULL || hpa->parent == NULL) {
+            fprintf(stderr, "Error allocating hierarchy search buffers\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i <= goal; i++) {
+        hpa->g[i] = UNREACHABLE;
+        hpa->parent[i] = -1;
+    }
+
+    /* Distances from each entrance of END's cluster to END */
+    int_list_t *members = &hpa->scratch;
+    CollectClusterNodes(hpa, endCluster, members);
+    LocalBfs(hpa, endCluster, end);
+    for (int i = 0; i < members->count; i++) {
+        hpa_node_t *node = &hpa->nodes[members->items[i]];
+        node->goalCost = hpa->localDist[LocalIndex(hpa, endCluster, node->cell)];
+    }
+    int endMembers = members->count;
+    int_list_t endNodes = {malloc((size_t)(endMembers + 1) * sizeof(int)),
+                           endMembers, endMembers + 1};
+    if (endNodes.items == NULL) {
+        fprintf(stderr, "Error allocating hierarchy search buffers\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(endNodes.items, members->items, (size_t)endMembers * sizeof(int));
+
+    /* Seed the open list with START's cluster entrances (and END itself
+     * when both lie in the same cluster) */
+    CollectClusterNodes(hpa, startCluster, members);
+    LocalBfs(hpa, startCluster, start);
+    for (int i = 0; i < members->count; i++) {
+        int id = members->items[i];
+        int dist = hpa->localDist[LocalIndex(hpa, startCluster,
+                                             hpa->nodes[id].cell)];
+        if (dist >= 0) {
+            int cell = hpa->nodes[id].cell;
+            int h = ManhattanDistance(cell / map->cols, cell % map->cols,
+                                      endRow, endColumn);
+            hpa->g[id] = dist;
+            HeapPush(hpa->open, id, ((uint64_t)(dist + h) << 32) | (uint32_t)h);
+        }
+    }
+    if (startCluster == endCluster &&
+        hpa->localDist[LocalIndex(hpa, startCluster, end)] >= 0) {
+        hpa->g[goal] = hpa->localDist[LocalIndex(hpa, startCluster, end)];
+        HeapPush(hpa->open, goal, (uint64_t)hpa->g[goal] << 32);
+    }
+
+    while (hpa->open->size > 0) {
+        int id = HeapPop(hpa->open);
+        hpa->expanded++;
+        if (id == goal) {
+            break;
+        }
+
+        const hpa_node_t *node = &hpa->nodes[id];
+        int candidates = node->edges.count + 2;
+        for (int k = 0; k < candidates; k++) {
+            int next, cost;
+
+            if (k < node->edges.count) {
+                next = node->edges.items[k];
+                cost = node->costs.items[k];
+            } else if (k == node->edges.count) {
+                next = node->partner;
+                cost = 1;
+            } else {
+                next = (node->goalCost >= 0) ? goal : -1;
+                cost = node->goalCost;
+            }
+            if (next < 0 || hpa->g[id] + cost >= hpa->g[next]) {
+                continue;
+            }
+
+            int h = 0;
+            if (next != goal) {
+                int cell = hpa->nodes[next].cell;
+                h = ManhattanDistance(cell / map->cols, cell % map->cols,
+                                      endRow, endColumn);
+            }
+            hpa->g[next] = hpa->g[id] + cost;
+            hpa->parent[next] = id;
+            HeapPush(hpa->open, next,
+                     ((uint64_t)(hpa->g[next] + h) << 32) | (uint32_t)h);
+        }
+    }
+    HeapClear(hpa->open);
+
+    for (int i = 0; i < endNodes.count; i++) {
+        hpa->nodes[endNodes.items[i]].goalCost = -1;
+    }
+    free(endNodes.items);
+
+    if (hpa->g[goal] >= UNREACHABLE) {
+        return -1;
+    }
+
+    if (mark) {
+        /* Walk the abstract path backwards from END, refining each hop */
+        int to = end;
+        for (int id = hpa->parent[goal]; id >= 0; id = hpa->parent[id]) {
+            RefineSegment(hpa, hpa->nodes[id].cell, to);
+            to = hpa->nodes[id].cell;
+        }
+        RefineSegment(hpa, start, to);
+        /* RefineSegment marks both ends; START and END render as S and E */
+    }
+
+    return hpa->g[goal];
+}
+
+/*==========================================================*
+*                   DISTANCE FIELD CACHE                    *
+*==========================================================*/
+/**
+ * @brief: Creates an empty cache of distance fields allowed to hold at
+ *         most budget bytes of fields
+ * @return: Pointer to the new cache, exits on failure
+*/
+field_cache_t *CreateFieldCache(const map_t *map, size_t budget) {
+    field_cache_t *cache = calloc(1, sizeof(*cache));
+    if (cache == NULL) {
+        fprintf(stderr, "Error allocating distance field cache\n");
+        exit(EXIT_FAILURE);
+    }
+
+    cache->map = map;
+    cache->budget = budget;
+    pthread_mutex_init(&cache->lock, NULL);
+    pthread_cond_init(&cache->ready, NULL);
+    return cache;
+}
+
+static inline size_t FieldBytes(const map_t *map) {
+    return sizeof(distance_field_t) +
+           (size_t)map->rows * map->cols * sizeof(int);
+}
+
+static void UnlinkField(field_cache_t *cache, distance_field_t *field) {
+    if (field->prev != NULL) {
+        field->prev->next = field->next;
+    } else {
+        cache->head = field->next;
+    }
+    if (field->next != NULL) {
+        field->next->prev = field->prev;
+    } else {
+        cache->tail = field->prev;
+    }
+}
+
+static void PushFrontField(field_cache_t *cache, distance_field_t *field) {
+    field->prev = NULL;
+    field->next = cache->head;
+    if (cache->head != NULL) {
+        cache->head->prev = field;
+    } else {
+        cache->tail = field;
+    }
+    cache->head = field;
+}
+
+/**
+ * @brief: Drops every cached field. Only called between runs of queries,
+ *         when no worker holds a reference, e.g. after the map changed
+*/
+void FlushFieldCache(field_cache_t *cache) {
+    while (cache->head != NULL) {
+        distance_field_t *field = cache->head;
+        UnlinkField(cache, field);
+        free(field->dist);
+        free(field);
+    }
+    cache->used = 0;
+}
+
+void FreeFieldCache(field_cache_t *cache) {
+    if (cache == NULL) {
+        return;
+    }
+
+    FlushFieldCache(cache);
+    pthread_mutex_destroy(&cache->lock);
+    pthread_cond_destroy(&cache->ready);
+    free(cache);
+}
+
+/**
+ * @brief: Fills field->dist with the BFS distance of every cell to the
+ *         field's destination (the grid is undirected, so this is also
+ *         the distance from each cell to it)
+*/
+static void BuildDistanceField(const map_t *map, search_ctx_t *ctx,
+                               distance_field_t *field) {
+    for (int i = 0; i < map->rows * map->cols; i++) {
+        field->dist[i] = UNREACHABLE;
+    }
+
+    ctx->queue.head = 0;
+    ctx->queue.count = 0;
+    field->dist[field->end] = 0;
+    QueuePush(&ctx->queue, field->end);
+
+    while (ctx->queue.count > 0) {
+        int cell = QueuePop(&ctx->queue);
+        int row = cell / map->cols;
+        int col = cell % map->cols;
+
+        for (int i = 0; i < 4; i++) {
+            int nextRow = row + rowDir[i];
+            int nextCol = col + colDir[i];
+            if (!IsOpen(map, nextRow, nextCol)) {
+                continue;
+            }
+
+            int next = CellId(map, nextRow, nextCol);
+            if (field->dist[next] == UNREACHABLE) {
+                field->dist[next] = field->dist[cell] + 1;
+                QueuePush(&ctx->queue, next);
+            }
+        }
+    }
+}
+
+/**
+ * @brief: Looks up the distance field towards END cell end, building it
+ *         with ctx on a miss. Least recently used fields nobody holds are
+ *         evicted until the new one fits the budget. A worker asking for a
+ *         field another worker is still building waits for it
+ * @return: Field with one reference held by the caller (see ReleaseField),
+ *          NULL if the budget is too small for another field right now
+*/
+distance_field_t *AcquireField(field_cache_t *cache, search_ctx_t *ctx,
+                               int end) {
+    const map_t *map = cache->map;
+    size_t bytes = FieldBytes(map);
+    distance_field_t *field;
+
+    pthread_mutex_lock(&cache->lock);
+    /* Budgets hold few fields, so a linear scan is cheaper than a hash */
+    for (field = cache->head; field != NULL; field = field->next) {
+        if (field->end == end) {
+            break;
+        }
+    }
+
+    if (field != NULL) {
+        cache->hits++;
+        field->refs++;
+        UnlinkField(cache, field);
+        PushFrontField(cache, field);
+        while (!field->built) {
+            pthread_cond_wait(&cache->ready, &cache->lock);
+        }
+        pthread_mutex_unlock(&cache->lock);
+        return field;
+    }
+
+    cache->misses++;
+    for (distance_field_t *victim = cache->tail;
+         victim != NULL && cache->used + bytes > cache->budget;) {
+        distance_field_t *prev = victim->prev;
+        if (victim->refs == 0) {
+            UnlinkField(cache, victim);
+            free(victim->dist);
+            free(victim);
+            cache->used -= bytes;
+        }
+        victim = prev;
+    }
+    if (cache->used + bytes > cache->budget) {
+        pthread_mutex_unlock(&cache->lock);
+        return NULL;
+    }
+
+    field = malloc(sizeof(*field));
+    int *dist = malloc((size_t)map->rows * map->cols * sizeof(int));
+    if (field == NULL || dist == NULL) {
+        fprintf(stderr, "Error allocating distance field\n");
+        exit(EXIT_FAILURE);
+    }
+    field->end = end;
+    field->dist = dist;
+    field->refs = 1;
+    field->built = false;
+    PushFrontField(cache, field);
+    cache->used += bytes;
+    pthread_mutex_unlock(&cache->lock);
+
+    /* Build outside the lock; others find the entry and wait on ready */
+    BuildDistanceField(map, ctx, field);
+
+    pthread_mutex_lock(&cache->lock);
+    field->built = true;
+    pthread_cond_broadcast(&cache->ready);
+    pthread_mutex_unlock(&cache->lock);
+    return field;
+}
+
+void ReleaseField(field_cache_t *cache, distance_field_t *field) {
+    pthread_mutex_lock(&cache->lock);
+    field->refs--;
+    pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * @brief: Walks from (row, col) down the distance gradient to the field's
+ *         destination, one step per cell. With cells non-NULL the cell
+ *         ids of the route, END included, are written to it
+ * @return: Steps to the destination, -1 if it is unreachable
+*/
+int FollowField(const map_t *map, const distance_field_t *field, int row,
+                int col, int *cells) {
+    int cell = CellId(map, row, col);
+    int steps = field->dist[cell];
+
+    if (steps >= UNREACHABLE) {
+        return -1;
+    }
+
+    for (int k = 0; cells != NULL && k < steps; k++) {
+        row = cell / map->cols;
+        col = cell % map->cols;
+        for (int i = 0; i < 4; i++) {
+            int nextRow = row + rowDir[i];
+            int nextCol = col + colDir[i];
+            if (IsOpen(map, nextRow, nextCol) &&
+                field->dist[CellId(map, nextRow, nextCol)] ==
+                    field->dist[cell] - 1) {
+                cell = CellId(map, nextRow, nextCol);
+                break;
+            }
+        }
+        cells[k] = cell;
+    }
+
+    return steps;
+}
+
+/*==========================================================*
+*                       BATCH QUERIES                       *
+*==========================================================*/
+/**
+ * @brief: Reads "startRow startCol endRow endCol", "block row col" and
+ *         "unblock row col" lines until end of input
+ * @return: Array of queries (caller frees), length stored in *count
+*/
+query_t *ReadQueries(int *count) {
+    int capacity = 64;
+    query_t *queries = malloc((size_t)capacity * sizeof(*queries));
+    query_t q;
+    char word[16];
+
+    *count = 0;
+    while (queries != NULL && scanf("%15s", word) == 1) {
+        q.endRow = q.endCol = -1;
+        if (!strcmp(word, "block") || !strcmp(word, "unblock")) {
+            q.kind = (word[0] == 'b') ? QUERY_BLOCK : QUERY_UNBLOCK;
+            if (scanf("%d %d", &q.startRow, &q.startCol) != 2) {
+                fprintf(stderr, "Error reading block event #%d\n", *count + 1);
+                exit(EXIT_FAILURE);
+            }
+        } else {
+            char *rest;
+            long row = strtol(word, &rest, 10);
+
+            q.kind = QUERY_PATH;
+            q.startRow = (int)row;
+            if (rest == word || *rest != '\0' || row < INT_MIN ||
+                row > INT_MAX ||
+                scanf("%d %d %d", &q.startCol, &q.endRow, &q.endCol) != 3) {
+                fprintf(stderr, "Error reading query #%d\n", *count + 1);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        if (*count == capacity) {
+            capacity *= 2;
+            queries = realloc(queries, (size_t)capacity * sizeof(*queries));
+            if (queries == NULL) {
+                break;
+            }
+        }
+        q.steps = -1;
+        queries[(*count)++] = q;
+    }
+
+    if (queries == NULL) {
+        fprintf(stderr, "Error allocating batch queries\n");
+        exit(EXIT_FAILURE);
+    }
+    return queries;
+}
+
+/**
+ * @brief: Claims BATCH_CHUNK queries at a time and answers them with A*
+ *         on the worker's search context until the run is used up
+*/
+static void AnswerClaimed(batch_worker_t *worker) {
+    batch_t *batch = worker->batch;
+    const map_t *map = batch->map;
+    search_ctx_t *ctx = worker->ctx;
+
+    for (;;) {
+        pthread_mutex_lock(&batch->lock);
+        int first = batch->next;
+        batch->next += BATCH_CHUNK;
+        pthread_mutex_unlock(&batch->lock);
+
+        if (first >= batch->count) {
+            return;
+        }
+
+        int last = (first + BATCH_CHUNK < batch->count) ? first + BATCH_CHUNK
+                                                        : batch->count;
+        for (int i = first; i < last; i++) {
+            query_t *q = &batch->queries[i];
+            if (!IsOpen(map, q->startRow, q->startCol) ||
+                !IsOpen(map, q->endRow, q->endCol) ||
+                !MayReach(map, q->startRow, q->startCol, q->endRow, q->endCol)) {
+                continue;
+            }
+
+            distance_field_t *field = NULL;
+            if (batch->fields != NULL) {
+                field = AcquireField(batch->fields, ctx,
+                                     CellId(map, q->endRow, q->endCol));
+            }
+            if (field != NULL) {
+                q->steps = FollowField(map, field, q->startRow, q->startCol,
+                                       NULL);
+                ReleaseField(batch->fields, field);
+            } else {
+                q->steps = AStarPath(map, ctx, q->startRow, q->startCol,
+                                     q->endRow, q->endCol);
+            }
+        }
+    }
+}
+
+/**
+ * @brief: Worker thread: answers its share of every run until the pool
+ *         is released
+*/
+void *BatchWorker(void *arg) {
+    batch_worker_t *worker = arg;
+    batch_t *batch = worker->batch;
+
+    for (;;) {
+        pthread_barrier_wait(&batch->start);
+        if (batch->done) {
+            return NULL;
+        }
+        AnswerClaimed(worker);
+        pthread_barrier_wait(&batch->finish);
+    }
+}
+
+/**
+ * @brief: Answers queries [first, last) on the pool, the calling thread
+ *         included, sharing the map read-only
+*/
+static void AnswerQueries(batch_t *batch, int first, int last) {
+    if (first == last) {
+        return;
+    }
+
+    batch->next = first;
+    batch->count = last;
+    pthread_barrier_wait(&batch->start);
+    AnswerClaimed(&batch->workers[0]);
+    pthread_barrier_wait(&batch->finish);
+}
+
+/**
+ * @brief: Starts threads - 1 workers, each with a search context over the
+ *         whole map, and parks them on the start barrier
+*/
+static void StartBatchPool(batch_t *batch, int threads) {
+    const map_t *map = batch->map;
+
+    batch->threads = threads;
+    batch->done = false;
+    batch->workers = calloc((size_t)threads, sizeof(batch_worker_t));
+    if (batch->workers == NULL) {
+        fprintf(stderr, "Error allocating %d workers\n", threads);
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_barrier_init(&batch->start, NULL, (unsigned)threads);
+    pthread_barrier_init(&batch->finish, NULL, (unsigned)threads);
+    for (int i = 0; i < threads; i++) {
+        batch->workers[i].batch = batch;
+        batch->workers[i].ctx = CreateSearchContext(map->rows * map->cols);
+        if (i > 0 && pthread_create(&batch->workers[i].thread, NULL,
+                                    BatchWorker, &batch->workers[i]) != 0) {
+            fprintf(stderr, "Error starting worker #%d\n", i + 1);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static void StopBatchPool(batch_t *batch) {
+    batch->done = true;
+    pthread_barrier_wait(&batch->start);
+    for (int i = 1; i < batch->threads; i++) {
+        pthread_join(batch->workers[i].thread, NULL);
+    }
+    for (int i = 0; i < batch->threads; i++) {
+        FreeSearchContext(batch->workers[i].ctx);
+    }
+    pthread_barrier_destroy(&batch->start);
+    pthread_barrier_destroy(&batch->finish);
+    free(batch->workers);
+}
+
+/**
+ * @brief: Reads every remaining query and event. Runs of queries between
+ *         events are answered in parallel; each block/unblock event is applied
+ *         on its own in between, keeping the component index current so
+ *         queries across components are rejected without searching.
+ *         With fieldBytes > 0, a BFS distance field is cached per END and
+ *         later queries to that END read their answer from it instead of
+ *         searching; events flush the cache. Answers are printed in
+ *         input order
+*/
+void RunBatch(map_t *map, int threads, size_t fieldBytes) {
+    batch_t batch;
+    int total;
+
+    batch.map = map;
+    batch.queries = ReadQueries(&total);
+    batch.fields = (fieldBytes > 0) ? CreateFieldCache(map, fieldBytes) : NULL;
+    pthread_mutex_init(&batch.lock, NULL);
+
+    if (map->components == NULL) {
+        map->components = BuildComponents(map);
+    }
+
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    StartBatchPool(&batch, threads);
+
+    int first = 0;
+    for (int i = 0; i <= total; i++) {
+        if (i < total && batch.queries[i].kind == QUERY_PATH) {
+            continue;
+        }
+
+        AnswerQueries(&batch, first, i);
+        if (i < total && batch.fields != NULL) {
+            FlushFieldCache(batch.fields);
+        }
+        if (i < total && batch.queries[i].kind == QUERY_BLOCK) {
+            AddBlock(map, batch.queries[i].startRow, batch.queries[i].startCol);
+        } else if (i < total) {
+            RemoveBlock(map, batch.queries[i].startRow,
+                        batch.queries[i].startCol);
+        }
+        first = i + 1;
+    }
+
+    for (int i = 0, number = 1; i < total; i++) {
+        if (batch.queries[i].kind != QUERY_PATH) {
+            continue;
+        }
+        if (batch.queries[i].steps >= 0) {
+            printf("Query %d: %d steps\n", number++, batch.queries[i].steps);
+        } else {
+            printf("Query %d: no path\n", number++);
+        }
+    }
+
+    StopBatchPool(&batch);
+    pthread_mutex_destroy(&batch.lock);
+    FreeFieldCache(batch.fields);
+    free(batch.queries);
+}
+
+/*==========================================================*
+*                       PARALLEL BFS                        *
+*==========================================================*/
+/**
+ * @brief: Range of items the worker handles out of total, split evenly
+*/
+static inline void WorkerSlice(const bfs_worker_t *worker, size_t total,
+                               size_t *first, size_t *last) {
+    int threads = worker->bfs->threads;
+    *first = total * worker->id / threads;
+    *last = total * (worker->id + 1) / threads;
+}
+
+/**
+ * @brief: BFS_PHASE_OPEN - fills the worker's words of the open bitmap
+*/
+static void BuildOpenSlice(bfs_worker_t *worker) {
+    parallel_bfs_t *bfs = worker->bfs;
+    const map_t *map = bfs->map;
+    size_t cells = (size_t)map->rows * map->cols;
+    size_t first, last;
+    long count = 0;
+
+    WorkerSlice(worker, bfs->words, &first, &last);
+    for (size_t w = first; w < last; w++) {
+        uint64_t bits = 0;
+        for (int b = 0; b < WORD_BITS && w * WORD_BITS + b < cells; b++) {
+            int cell = (int)(w * WORD_BITS + b);
+            if (!IsBlocked(map, cell / map->cols, cell % map->cols)) {
+                bits |= (uint64_t)1 << b;
+            }
+        }
+        bfs->open[w] = bits;
+        count += __builtin_popcountll(bits);
+    }
+    __atomic_fetch_add(&bfs->openCount, count, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief: BFS_PHASE_TOP_DOWN - claims the unvisited free neighbours of
+ *         the worker's slice of the frontier. Only the thread whose
+ *         fetch-or set a bit adds that cell to the next level
+*/
+static void TopDownSlice(bfs_worker_t *worker) {
+    parallel_bfs_t *bfs = worker->bfs;
+    int cols = bfs->map->cols, rows = bfs->map->rows;
+    size_t first, last;
+
+    WorkerSlice(worker, (size_t)bfs->frontierCount, &first, &last);
+    for (size_t i = first; i < last; i++) {
+        int cell = bfs->frontier[i];
+        int row = cell / cols;
+        int col = cell % cols;
+
+        for (int d = 0; d < 4; d++) {
+            int nextRow = row + rowDir[d];
+            int nextCol = col + colDir[d];
+            if (nextRow < 0 || nextRow >= rows || nextCol < 0 || nextCol >= cols) {
+                continue;
+            }
+
+            size_t next = (size_t)nextRow * cols + nextCol;
+            uint64_t *word = &bfs->visited[next / WORD_BITS];
+            uint64_t mask = (uint64_t)1 << (next % WORD_BITS);
+            if (!TestBit(bfs->open, next) ||
+                (__atomic_load_n(word, __ATOMIC_RELAXED) & mask)) {
+                continue;
+            }
+            if (!(__atomic_fetch_or(word, mask, __ATOMIC_RELAXED) & mask)) {
+                ListPush(&worker->found, (int)next);
+            }
+        }
+    }
+}
+
+/**
+ * @brief: BFS_PHASE_BOTTOM_UP - every unvisited free cell in the worker's
+ *         words joins the next level if a neighbour is visited. Every
+ *         visited cell with an unvisited neighbour is on the frontier, so
+ *         no frontier bitmap is needed; finds go to fresh, not visited,
+ *         so that no cell sees a neighbour found in this same level
+*/
+static void BottomUpSlice(bfs_worker_t *worker) {
+    parallel_bfs_t *bfs = worker->bfs;
+    int cols = bfs->map->cols, rows = bfs->map->rows;
+    size_t first, last;
+
+    WorkerSlice(worker, bfs->words, &first, &last);
+    for (size_t w = first; w < last; w++) {
+        for (uint64_t rest = bfs->open[w] & ~bfs->visited[w]; rest;
+             rest &= rest - 1) {
+            size_t cell = w * WORD_BITS + __builtin_ctzll(rest);
+            int row = (int)(cell / cols);
+            int col = (int)(cell % cols);
+
+            if ((row > 0 && TestBit(bfs->visited, cell - cols)) ||
+                (row < rows - 1 && TestBit(bfs->visited, cell + cols)) ||
+                (col > 0 && TestBit(bfs->visited, cell - 1)) ||
+                (col < cols - 1 && TestBit(bfs->visited, cell + 1))) {
+                bfs->fresh[w] |= rest & -rest;
+                ListPush(&worker->found, (int)cell);
+            }
+        }
+    }
+}
+
+/**
+ * @brief: BFS_PHASE_MERGE - moves the worker's words of fresh into visited
+*/
+static void MergeSlice(bfs_worker_t *worker) {
+    parallel_bfs_t *bfs = worker->bfs;
+    size_t first, last;
+
+    WorkerSlice(worker, bfs->words, &first, &last);
+    for (size_t w = first; w < last; w++) {
+        bfs->visited[w] |= bfs->fresh[w];
+        bfs->fresh[w] = 0;
+    }
+}
+
+static void RunSlice(bfs_worker_t *worker) {
+    switch (worker->bfs->phase) {
+    case BFS_PHASE_OPEN:
+        BuildOpenSlice(worker);
+        break;
+    case BFS_PHASE_TOP_DOWN:
+        TopDownSlice(worker);
+        break;
+    case BFS_PHASE_BOTTOM_UP:
+        BottomUpSlice(worker);
+        break;
+    case BFS_PHASE_MERGE:
+        MergeSlice(worker);
+        break;
+    }
+}
+
+static void *ParallelBfsWorker(void *arg) {
+    bfs_worker_t *worker = arg;
+    parallel_bfs_t *bfs = worker->bfs;
+
+    for (;;) {
+        pthread_barrier_wait(&bfs->start);
+        if (bfs->phase == BFS_PHASE_EXIT) {
+            return NULL;
+        }
+        RunSlice(worker);
+        pthread_barrier_wait(&bfs->finish);
+    }
+}
+
+/**
+ * @brief: Runs one phase on the whole pool, the calling thread included,
+ *         and returns once every slice is done
+*/
+static void RunBfsPhase(parallel_bfs_t *bfs, int phase) {
+    bfs->phase = phase;
+    pthread_barrier_wait(&bfs->start);
+    RunSlice(&bfs->workers[0]);
+    pthread_barrier_wait(&bfs->finish);
+}
+
+/**
+ * @brief: Starts a pool of threads (all cores when threads <= 0) and
+ *         builds the open-cell bitmap of the map with it. The map must
+ *         not change while the pool exists
+ * @return: Pointer to the new parallel BFS state, exits on failure
+*/
+parallel_bfs_t *CreateParallelBfs(const map_t *map, int threads) {
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    parallel_bfs_t *bfs = malloc(sizeof(*bfs));
+    if (bfs == NULL) {
+        fprintf(stderr, "Error allocating parallel BFS\n");
+        exit(EXIT_FAILURE);
+    }
+
+    bfs->map = map;
+    bfs->threads = threads;
+    bfs->words = ((size_t)map->rows * map->cols + WORD_BITS - 1) / WORD_BITS;
+    bfs->open = malloc(bfs->words * sizeof(uint64_t));
+    bfs->visited = calloc(bfs->words, sizeof(uint64_t));
+    bfs->fresh = calloc(bfs->words, sizeof(uint64_t));
+    bfs->workers = calloc((size_t)threads, sizeof(bfs_worker_t));
+    bfs->frontierCapacity = 1024;
+    bfs->frontier = malloc((size_t)bfs->frontierCapacity * sizeof(int));
+    if (bfs->open == NULL || bfs->visited == NULL || bfs->fresh == NULL ||
+        bfs->workers == NULL || bfs->frontier == NULL) {
+        fprintf(stderr, "Error allocating parallel BFS buffers\n");
+        exit(EXIT_FAILURE);
+    }
+    bfs->frontierCount = 0;
+    bfs->openCount = 0;
+    bfs->reached = 0;
+    bfs->levels = bfs->bottomUpLevels = 0;
+
+    pthread_barrier_init(&bfs->start, NULL, (unsigned)threads);
+    pthread_barrier_init(&bfs->finish, NULL, (unsigned)threads);
+    for (int i = 0; i < threads; i++) {
+        bfs->workers[i].bfs = bfs;
+        bfs->workers[i].id = i;
+        if (i > 0 && pthread_create(&bfs->workers[i].thread, NULL,
+                                    ParallelBfsWorker, &bfs->workers[i]) != 0) {
+            fprintf(stderr, "Error starting BFS thread %d\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    RunBfsPhase(bfs, BFS_PHASE_OPEN);
+    return bfs;
+}
+
+void FreeParallelBfs(parallel_bfs_t *bfs) {
+    if (bfs == NULL) {
+        return;
+    }
+
+    bfs->phase = BFS_PHASE_EXIT;
+    pthread_barrier_wait(&bfs->start);
+    for (int i = 1; i < bfs->threads; i++) {
+        pthread_join(bfs->workers[i].thread, NULL);
+    }
+    for (int i = 0; i < bfs->threads; i++) {
+        free(bfs->workers[i].found.items);
+    }
+    pthread_barrier_destroy(&bfs->start);
+    pthread_barrier_destroy(&bfs->finish);
+    free(bfs->workers);
+    free(bfs->frontier);
+    free(bfs->open);
+    free(bfs->visited);
+    free(bfs->fresh);
+    free(bfs);
+}
+
+/**
+ * @brief: Gathers the cells every worker found into the next frontier
+*/
+static void CollectFrontier(parallel_bfs_t *bfs) {
+    int total = 0;
+    for (int i = 0; i < bfs->threads; i++) {
+        total += bfs->workers[i].found.count;
+    }
+    if (total > bfs->frontierCapacity) {
+        bfs->frontierCapacity = total;
+        free(bfs->frontier);
+        bfs->frontier = malloc((size_t)total * sizeof(int));
+        if (bfs->frontier == NULL) {
+            fprintf(stderr, "Error growing BFS frontier to %d cells\n", total);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    bfs->frontierCount = 0;
+    for (int i = 0; i < bfs->threads; i++) {
+        int_list_t *found = &bfs->workers[i].found;
+        memcpy(bfs->frontier + bfs->frontierCount, found->items,
+               (size_t)found->count * sizeof(int));
+        bfs->frontierCount += found->count;
+        found->count = 0;
+    }
+}
+
+/**
+ * @brief: Parallel breadth-first search from START to END, one barrier
+ *         step per level. A level runs bottom-up once the frontier is
+ *         growing and bigger than 1/BFS_BOTTOM_UP_ALPHA of the unvisited
+ *         cells, and top-down again once it shrinks below
+ *         1/BFS_TOP_DOWN_BETA of all free cells (Beamer's heuristic with
+ *         cells standing in for edges, as every cell has at most four)
+ * @return: Distance from START to END in steps, -1 if END is unreachable
+*/
+int ParallelDistance(parallel_bfs_t *bfs, int startRow, int startColumn,
+                     int endRow, int endColumn) {
+    const map_t *map = bfs->map;
+    size_t endCell = (size_t)endRow * map->cols + endColumn;
+
+    memset(bfs->visited, 0, bfs->words * sizeof(uint64_t));
+    bfs->levels = bfs->bottomUpLevels = 0;
+    bfs->reached = 1;
+    bfs->frontier[0] = startRow * map->cols + startColumn;
+    bfs->frontierCount = 1;
+    SetBit(bfs->visited, (size_t)bfs->frontier[0]);
+    if ((size_t)bfs->frontier[0] == endCell) {
+        return 0;
+    }
+
+    bool bottomUp = false;
+    while (bfs->frontierCount > 0) {
+        int previous = bfs->frontierCount;
+
+        if (bottomUp) {
+            RunBfsPhase(bfs, BFS_PHASE_BOTTOM_UP);
+            RunBfsPhase(bfs, BFS_PHASE_MERGE);
+            bfs->bottomUpLevels++;
+        } else {
+            RunBfsPhase(bfs, BFS_PHASE_TOP_DOWN);
+        }
+        bfs->levels++;
+        CollectFrontier(bfs);
+        bfs->reached += bfs->frontierCount;
+
+        if (TestBit(bfs->visited, endCell)) {
+            return bfs->levels;
+        }
+
+        long unvisited = bfs->openCount - bfs->reached;
+        if (!bottomUp && bfs->frontierCount > previous &&
+            bfs->frontierCount > unvisited / BFS_BOTTOM_UP_ALPHA) {
+            bottomUp = true;
+        } else if (bottomUp && bfs->frontierCount < previous &&
+                   bfs->frontierCount < bfs->openCount / BFS_TOP_DOWN_BETA) {
+            bottomUp = false;
+        }
+    }
+
+    return -1;
+}
+
+/*==========================================================*
+*                     RUN-LENGTH ROWS                       *
+*==========================================================*/
+/**
+ * @brief: First column at or after col whose blocked bit equals blocked.
+ *         Row-major maps skip whole words with one test each
+ * @return: That column, or map->cols if there is none
+*/
+static int NextInRow(const map_t *map, int row, int col, bool blocked) {
+    if (map->layout != LAYOUT_ROWMAJOR) {
+        while (col < map->cols && IsBlocked(map, row, col) != blocked) {
+            col++;
+        }
+        return col;
+    }
+
+    const uint64_t *words = map->blocked + (size_t)row * map->rowWords;
+    int w = col / WORD_BITS;
+    uint64_t bits = blocked ? words[w] : ~words[w];
+    bits &= ~(uint64_t)0 << (col % WORD_BITS);
+    while (bits == 0 && ++w < map->rowWords) {
+        bits = blocked ? words[w] : ~words[w];
+    }
+    if (w >= map->rowWords) {
+        return map->cols;
+    }
+    col = w * WORD_BITS + __builtin_ctzll(bits);
+    return (col < map->cols) ? col : map->cols;
+}
+
+/**
+ * @brief: Collects the free runs of every row of the map
+ * @return: Pointer to the new run-length map, exits on failure
+*/
+rle_map_t *BuildRleMap(const map_t *map) {
+    rle_map_t *rle = malloc(sizeof(*rle));
+    if (rle == NULL) {
+        fprintf(stderr, "Error allocating run-length map\n");
+        exit(EXIT_FAILURE);
+    }
+
+    rle->rows = map->rows;
+    rle->cols = map->cols;
+    rle->rowStart = malloc(((size_t)map->rows + 1) * sizeof(int));
+    rle->runCapacity = map->rows + 16;
+    rle->runs = malloc((size_t)rle->runCapacity * sizeof(interval_t));
+    rle->runCount = 0;
+    if (rle->rowStart == NULL || rle->runs == NULL) {
+        fprintf(stderr, "Error allocating run-length map\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int row = 0; row < map->rows; row++) {
+        rle->rowStart[row] = rle->runCount;
+        for (int col = NextInRow(map, row, 0, false); col < map->cols;
+             col = NextInRow(map, row, col, false)) {
+            int end = NextInRow(map, row, col, true);
+
+            if (rle->runCount == rle->runCapacity) {
+                rle->runCapacity *= 2;
+                rle->runs = realloc(rle->runs,
+                                    (size_t)rle->runCapacity * sizeof(interval_t));
+                if (rle->runs == NULL) {
+                    fprintf(stderr, "Error growing run-length map\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+            rle->runs[rle->runCount].row = row;
+            rle->runs[rle->runCount].first = col;
+            rle->runs[rle->runCount].last = end - 1;
+            rle->runCount++;
+            col = end;
+        }
+    }
+    rle->rowStart[map->rows] = rle->runCount;
+    return rle;
+}
+
+void FreeRleMap(rle_map_t *rle) {
+    if (rle == NULL) {
+        return;
+    }
+
+    free(rle->rowStart);
+    free(rle->runs);
+    free(rle);
+}
+
+/**
+ * @brief: Binary search for the first run of row whose last column is at
+ *         or after col
+ * @return: Run id, rowStart[row + 1] if every run ends before col
+*/
+static int FirstRunFrom(const rle_map_t *rle, int row, int col) {
+    int low = rle->rowStart[row], high = rle->rowStart[row + 1];
+
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (rle->runs[mid].last < col) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+/**
+ * @brief: Finds the run holding a cell
+ * @return: Run id, -1 if the cell is blocked or outside the map
+*/
+int FindRun(const rle_map_t *rle, int row, int col) {
+    if (row < 0 || row >= rle->rows || col < 0 || col >= rle->cols) {
+        return -1;
+    }
+
+    int run = FirstRunFrom(rle, row, col);
+    if (run < rle->rowStart[row + 1] && rle->runs[run].first <= col) {
+        return run;
+    }
+    return -1;
+}
+
+/**
+ * @brief: Scan-line flood fill from START's run: each step takes a whole
+ *         run off the queue and queues every unseen run of the rows above
+ *         and below that overlaps it, so the work grows with the number of
+ *         runs rather than cells. Gives reachability, not step counts.
+ *         seen (runCount entries) is set for every run queued, and
+ *         *runsExpanded counts the runs taken off the queue
+ * @return: Runs on the shortest chain from START's run to END's (1 when
+ *          both share a run), -1 if END is unreachable
+*/
+int IntervalReach(const rle_map_t *rle, int startRow, int startColumn,
+                  int endRow, int endColumn, bool *seen, int *runsExpanded) {
+    int startRun = FindRun(rle, startRow, startColumn);
+    int endRun = FindRun(rle, endRow, endColumn);
+    int *queue = malloc(((size_t)rle->runCount + 1) * sizeof(int));
+    if (queue == NULL) {
+        fprintf(stderr, "Error allocating run queue\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(seen, 0, (size_t)rle->runCount * sizeof(bool));
+    *runsExpanded = 0;
+    if (startRun < 0 || endRun < 0) {
+        free(queue);
+        return -1;
+    }
+
+    int head = 0, tail = 0;
+    queue[tail++] = startRun;
+    seen[startRun] = true;
+    for (int chain = 1; head < tail; chain++) {
+        int layerEnd = tail;
+
+        while (head < layerEnd) {
+            const interval_t *run = &rle->runs[queue[head]];
+            (*runsExpanded)++;
+            if (queue[head++] == endRun) {
+                free(queue);
+                return chain;
+            }
+
+            for (int next = run->row - 1; next <= run->row + 1; next += 2) {
+                if (next < 0 || next >= rle->rows) {
+                    continue;
+                }
+                for (int other = FirstRunFrom(rle, next, run->first);
+                     other < rle->rowStart[next + 1] &&
+                     rle->runs[other].first <= run->last;
+                     other++) {
+                    if (!seen[other]) {
+                        seen[other] = true;
+                        queue[tail++] = other;
+                    }
+                }
+            }
+        }
+    }
+
+    free(queue);
+    return -1;
+}
+
+/*==========================================================*
+*                 COOPERATIVE PATHFINDING                   *
+*==========================================================*/
+static inline uint64_t StKey(int cell, int time) {
+    return ((uint64_t)(uint32_t)time << 32 | (uint32_t)cell) + 1;
+}
+
+static void StTableInit(st_table_t *table, size_t capacity) {
+    table->capacity = capacity;
+    table->count = 0;
+    table->keys = calloc(capacity, sizeof(uint64_t));
+    table->values = malloc(capacity * sizeof(int));
+    if (table->keys == NULL || table->values == NULL) {
+        fprintf(stderr, "Error allocating space-time table\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void StTableFree(st_table_t *table) {
+    free(table->keys);
+    free(table->values);
+}
+
+static void StTableClear(st_table_t *table) {
+    memset(table->keys, 0, table->capacity * sizeof(uint64_t));
+    table->count = 0;
+}
+
+/**
+ * @brief: Linear probe for key, starting at its Fibonacci hash
+ * @return: Slot holding key, or the empty slot where it would go
+*/
+static size_t StSlot(const st_table_t *table, uint64_t key) {
+    size_t mask = table->capacity - 1;
+    size_t slot = (size_t)((key * 0x9e3779b97f4a7c15ull) >> 32) & mask;
+
+    while (table->keys[slot] != 0 && table->keys[slot] != key) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @return: Value stored for (cell, time), -1 if there is none
+*/
+static int StFind(const st_table_t *table, int cell, int time) {
+    size_t slot = StSlot(table, StKey(cell, time));
+    return (table->keys[slot] != 0) ? table->values[slot] : -1;
+}
+
+static void StInsert(st_table_t *table, int cell, int time, int value) {
+    if (2 * (table->count + 1) > table->capacity) {
+        st_table_t grown;
+        StTableInit(&grown, 2 * table->capacity);
+        for (size_t i = 0; i < table->capacity; i++) {
+            if (table->keys[i] != 0) {
+                size_t slot = StSlot(&grown, table->keys[i]);
+                grown.keys[slot] = table->keys[i];
+                grown.values[slot] = table->values[i];
+                grown.count++;
+            }
+        }
+        StTableFree(table);
+        *table = grown;
+    }
+
+    uint64_t key = StKey(cell, time);
+    size_t slot = StSlot(table, key);
+    table->count += table->keys[slot] == 0;
+    table->keys[slot] = key;
+    table->values[slot] = value;
+}
+
+/**
+ * @brief: Allocates an empty reservation table for the map
+ * @return: Pointer to the new planner, exits on failure
+*/
+cooperative_t *CreateCooperative(const map_t *map) {
+    size_t cells = (size_t)map->rows * map->cols;
+    cooperative_t *coop = malloc(sizeof(*coop));
+    if (coop == NULL) {
+        fprintf(stderr, "Error allocating cooperative planner\n");
+        exit(EXIT_FAILURE);
+    }
+
+    coop->map = map;
+    StTableInit(&coop->reserved, 1024);
+    StTableInit(&coop->closed, 1024);
+    coop->parkedAt = malloc(cells * sizeof(int));
+    coop->lastUse = malloc(cells * sizeof(int));
+    coop->nodeCapacity = 1024;
+    coop->nodes = malloc((size_t)coop->nodeCapacity * sizeof(st_node_t));
+    if (coop->parkedAt == NULL || coop->lastUse == NULL || coop->nodes == NULL) {
+        fprintf(stderr, "Error allocating cooperative planner\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(coop->parkedAt, -1, cells * sizeof(int));
+    memset(coop->lastUse, -1, cells * sizeof(int));
+    coop->stableTime = 0;
+    coop->nodeCount = 0;
+    coop->open = CreateRadixHeap();
+    coop->expanded = 0;
+    return coop;
+}
+
+void FreeCooperative(cooperative_t *coop) {
+    if (coop == NULL) {
+        return;
+    }
+
+    StTableFree(&coop->reserved);
+    StTableFree(&coop->closed);
+    free(coop->parkedAt);
+    free(coop->lastUse);
+    free(coop->nodes);
+    FreeRadixHeap(coop->open);
+    free(coop);
+}
+
+/**
+ * @brief: Reads "K" and then K "startRow startCol endRow endCol" lines
+ * @return: Newly allocated array of K unplanned agents
+*/
+agent_t *ReadAgents(int *count) {
+    if (scanf("%d", count) != 1 || *count < 0) {
+        fprintf(stderr, "Error reading number of agents\n");
+        exit(EXIT_FAILURE);
+    }
+
+    agent_t *agents = calloc((size_t)*count + 1, sizeof(agent_t));
+    if (agents == NULL) {
+        fprintf(stderr, "Error allocating %d agents\n", *count);
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < *count; i++) {
+        agent_t *agent = &agents[i];
+        if (scanf("%d %d %d %d", &agent->startRow, &agent->startCol,
+                  &agent->endRow, &agent->endCol) != 4) {
+            fprintf(stderr, "Error reading agent #%d\n", i + 1);
+            exit(EXIT_FAILURE);
+        }
+        agent->steps = -1;
+    }
+    return agents;
+}
+
+/**
+ * @brief: True if agent id may stand on cell at time: the cell is free,
+ *         no other agent holds it then and none has parked on it by then
+*/
+static bool StFree(const cooperative_t *coop, int id, int cell, int time) {
+    int owner = StFind(&coop->reserved, cell, time);
+    return (owner < 0 || owner == id) &&
+           (coop->parkedAt[cell] < 0 || time < coop->parkedAt[cell]);
+}
+
+static int PushStNode(cooperative_t *coop, int cell, int time, int parent) {
+    if (coop->nodeCount == coop->nodeCapacity) {
+        coop->nodeCapacity *= 2;
+        coop->nodes = realloc(coop->nodes,
+                              (size_t)coop->nodeCapacity * sizeof(st_node_t));
+        if (coop->nodes == NULL) {
+            fprintf(stderr, "Error growing space-time search\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    int node = coop->nodeCount++;
+    coop->nodes[node].cell = cell;
+    coop->nodes[node].time = time;
+    coop->nodes[node].parent = parent;
+    return node;
+}
+
+/**
+ * @brief: Space-time A* for one agent: a state is a cell at a time step,
+ *         reached by a move or a wait of one step each. Keys are
+ *         f = time + Manhattan distance, which never decrease, so the
+ *         radix heap serves as the open list. Moves into a reserved or
+ *         parked cell, and swaps with the agent holding the target cell,
+ *         are pruned. After stableTime nothing moves any more, so later
+ *         times share one closed state per cell, which bounds the search
+ *         when END cannot be reached in time
+ * @return: Time the agent parks on END, -1 if there is no such plan
+*/
+static int PlanAgent(cooperative_t *coop, agent_t *agent, int id) {
+    const map_t *map = coop->map;
+    int startCell = CellId(map, agent->startRow, agent->startCol);
+    int endCell = CellId(map, agent->endRow, agent->endCol);
+
+    if (!MayReach(map, agent->startRow, agent->startCol, agent->endRow,
+                  agent->endCol) ||
+        StFind(&coop->reserved, startCell, 0) != id) {
+        return -1;
+    }
+
+    StTableClear(&coop->closed);
+    RadixClear(coop->open);
+    coop->nodeCount = 0;
+    int h = ManhattanDistance(agent->startRow, agent->startCol, agent->endRow,
+                              agent->endCol);
+    RadixPush(coop->open, (uint32_t)h, PushStNode(coop, startCell, 0, -1));
+
+    while (coop->open->size > 0) {
+        uint32_t key;
+        int node = RadixPop(coop->open, &key);
+        int cell = coop->nodes[node].cell;
+        int time = coop->nodes[node].time;
+        int stamp = (time <= coop->stableTime) ? time : coop->stableTime + 1;
+
+        if (StFind(&coop->closed, cell, stamp) >= 0) {
+            continue;
+        }
+        StInsert(&coop->closed, cell, stamp, node);
+        coop->expanded++;
+
+        /* END is final only if nobody passes over it afterwards */
+        if (cell == endCell && coop->lastUse[cell] < time &&
+            coop->parkedAt[cell] < 0) {
+            agent->steps = time;
+            agent->path = malloc(((size_t)time + 1) * sizeof(int));
+            if (agent->path == NULL) {
+                fprintf(stderr, "Error allocating agent path\n");
+                exit(EXIT_FAILURE);
+            }
+            for (int n = node; n >= 0; n = coop->nodes[n].parent) {
+                agent->path[coop->nodes[n].time] = coop->nodes[n].cell;
+            }
+            return time;
+        }
+
+        int row = cell / map->cols;
+        int col = cell % map->cols;
+        for (int i = -1; i < 4; i++) {
+            int nextRow = row + ((i < 0) ? 0 : rowDir[i]);
+            int nextCol = col + ((i < 0) ? 0 : colDir[i]);
+            if (!IsOpen(map, nextRow, nextCol)) {
+                continue;
+            }
+
+            int next = CellId(map, nextRow, nextCol);
+            if (!StFree(coop, id, next, time + 1)) {
+                continue;
+            }
+            int holder = StFind(&coop->reserved, next, time);
+            if (i >= 0 && holder >= 0 && holder != id &&
+                StFind(&coop->reserved, cell, time + 1) == holder) {
+                continue;
+            }
+            int nextStamp = (time + 1 <= coop->stableTime) ? time + 1
+                                                           : coop->stableTime + 1;
+            if (StFind(&coop->closed, next, nextStamp) >= 0) {
+                continue;
+            }
+
+            h = ManhattanDistance(nextRow, nextCol, agent->endRow, agent->endCol);
+            RadixPush(coop->open, (uint32_t)(time + 1 + h),
+                      PushStNode(coop, next, time + 1, node));
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief: Reserves every (cell, time) of a planned path and parks the
+ *         agent on its last cell from its arrival on
+*/
+static void ReservePath(cooperative_t *coop, agent_t *agent, int id) {
+    for (int time = 0; time <= agent->steps; time++) {
+        int cell = agent->path[time];
+        StInsert(&coop->reserved, cell, time, id);
+        if (coop->lastUse[cell] < time) {
+            coop->lastUse[cell] = time;
+        }
+        if (time > 0 && cell == agent->path[time - 1]) {
+            agent->waits++;
+        }
+    }
+    coop->parkedAt[agent->path[agent->steps]] = agent->steps;
+    if (coop->stableTime < agent->steps) {
+        coop->stableTime = agent->steps;
+    }
+}
+
+/**
+ * @brief: Cooperative A* over a batch of agents in input order. Every
+ *         START is reserved at time 0 first; then each agent is planned
+ *         against the paths of the agents before it, so no two planned
+ *         agents share a cell at a time step or swap cells. An agent
+ *         without a plan (steps -1) is assumed to stay on its START,
+ *         which only the agents after it are made to avoid
+*/
+void PlanAgents(cooperative_t *coop, agent_t *agents, int count) {
+    const map_t *map = coop->map;
+
+    for (int i = 0; i < count; i++) {
+        if (IsOpen(map, agents[i].startRow, agents[i].startCol) &&
+            IsOpen(map, agents[i].endRow, agents[i].endCol)) {
+            int cell = CellId(map, agents[i].startRow, agents[i].startCol);
+            if (StFind(&coop->reserved, cell, 0) < 0) {
+                StInsert(&coop->reserved, cell, 0, i);
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (PlanAgent(coop, &agents[i], i) >= 0) {
+            ReservePath(coop, &agents[i], i);
+        } else if (IsOpen(map, agents[i].startRow, agents[i].startCol)) {
+            coop->parkedAt[CellId(map, agents[i].startRow,
+                                  agents[i].startCol)] = 0;
+        }
+    }
+}
+
+/*==========================================================*
+*                     SEARCH STATISTICS                     *
+*==========================================================*/
+/**
+ * @brief: Zeroes the map's counters and starts the clock; no-op when the
+ *         map has no stats attached
+*/
+void StatsBegin(map_t *map) {
+    search_stats_t *stats = map->stats;
+    if (stats == NULL) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->pathLength = -1;
+    stats->startedNs = NowNanoseconds();
+}
+
+void StatsEnd(map_t *map) {
+    if (map->stats != NULL) {
+        map->stats->elapsedNs = NowNanoseconds() - map->stats->startedNs;
+    }
+}
+
+/**
+ * @brief: Stores the counters of a solver that does not update the stats
+ *         itself. Only depth-first solvers keep a stack, so maxDepth stays 0
+*/
+void RecordStats(map_t *map, long visited, long revisits, int pathLength) {
+    if (map->stats != NULL) {
+        map->stats->visited = visited;
+        map->stats->revisits = revisits;
+        map->stats->pathLength = pathLength;
+    }
+}
+
+/**
+ * @brief: RecordStats for the search_ctx_t solvers: every cell marked
+ *         seen counts as visited
+*/
+void RecordContextStats(map_t *map, const search_ctx_t *ctx, int pathLength) {
+    RecordStats(map, ctx->seenCount, ctx->revisits, pathLength);
+}
+
+void PrintStats(const search_stats_t *stats) {
+    printf("Stats: visited=%ld revisits=%ld backtracks=%ld max_depth=%d "
+           "path_length=%d elapsed_ns=%lld\n", stats->visited,
+           stats->revisits, stats->backtracks, stats->maxDepth,
+           stats->pathLength, stats->elapsedNs);
+}
+
+/*==========================================================*
+*                         BENCHMARK                         *
+*==========================================================*/
+/**
+ * @brief: xorshift64* step, so generated maps depend only on the seed
+ * @return: Next pseudo-random 64-bit value
+*/
+static uint64_t NextRandom(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545f4914f6cdd1dull;
+}
+
+static inline int RandomBelow(uint64_t *state, int bound) {
+    return (int)(NextRandom(state) % (uint64_t)bound);
+}
+
+static void SetEndpoints(map_t *map, int startRow, int startCol, int endRow,
+                         int endCol) {
+    ClearBlocked(map, startRow, startCol);
+    ClearBlocked(map, endRow, endCol);
+    map->startRow = startRow;
+    map->startCol = startCol;
+    map->endRow = endRow;
+    map->endCol = endCol;
+}
+
+static void FillBlocked(map_t *map) {
+    for (int row = 0; row < map->rows; row++) {
+        for (int col = 0; col < map->cols; col++) {
+            SetBlocked(map, row, col);
+        }
+    }
+}
+
+/**
+ * @brief: Blocks each cell independently with probability percent / 100,
+ *         START in the top-left corner and END in the bottom-right
+*/
+static void GenerateRandom(map_t *map, uint64_t *rng, int percent) {
+    for (int row = 0; row < map->rows; row++) {
+        for (int col = 0; col < map->cols; col++) {
+            if (RandomBelow(rng, 100) < percent) {
+                SetBlocked(map, row, col);
+            }
+        }
+    }
+    SetEndpoints(map, 0, 0, map->rows - 1, map->cols - 1);
+}
+
+/**
+ * @brief: Perfect maze by recursive backtracking over the even cells, run
+ *         with an explicit stack so large mazes cannot overflow
+*/
+static void GenerateMaze(map_t *map, uint64_t *rng, int unused) {
+    (void)unused;
+    int mazeRows = (map->rows + 1) / 2, mazeCols = (map->cols + 1) / 2;
+    int *stack = malloc((size_t)mazeRows * mazeCols * sizeof(int));
+    int depth = 0;
+
+    if (stack == NULL) {
+        fprintf(stderr, "Error allocating maze stack\n");
+        exit(EXIT_FAILURE);
+    }
+
+    FillBlocked(map);
+    ClearBlocked(map, 0, 0);
+    stack[depth++] = 0;
+    while (depth > 0) {
+        int cell = stack[depth - 1];
+        int row = 2 * (cell / mazeCols), col = 2 * (cell % mazeCols);
+        int choices[4], count = 0;
+
+        for (int i = 0; i < 4; i++) {
+            int nextRow = row + 2 * rowDir[i], nextCol = col + 2 * colDir[i];
+            if (InBounds(map, nextRow, nextCol) &&
+                IsBlocked(map, nextRow, nextCol)) {
+                choices[count++] = i;
+            }
+        }
+        if (count == 0) {
+            depth--;
+            continue;
+        }
+
+        int dir = choices[RandomBelow(rng, count)];
+        ClearBlocked(map, row + rowDir[dir], col + colDir[dir]);
+        ClearBlocked(map, row + 2 * rowDir[dir], col + 2 * colDir[dir]);
+        stack[depth++] = (row / 2 + rowDir[dir]) * mazeCols + col / 2 + colDir[dir];
+    }
+
+    free(stack);
+    SetEndpoints(map, 0, 0, 2 * (mazeRows - 1), 2 * (mazeCols - 1));
+}
+
+/**
+ * @brief: Random rectangular rooms, each joined to the previous one by an
+ *         L-shaped corridor; START and END are the first and last centres
+*/
+static void GenerateRooms(map_t *map, uint64_t *rng, int unused) {
+    (void)unused;
+    int rooms = map->rows * map->cols / 256 + 2;
+    int lastRow = 0, lastCol = 0, firstRow = 0, firstCol = 0;
+
+    FillBlocked(map);
+    for (int i = 0; i < rooms; i++) {
+        int height = 3 + RandomBelow(rng, 8), width = 3 + RandomBelow(rng, 8);
+        int top = RandomBelow(rng, map->rows), left = RandomBelow(rng, map->cols);
+        int bottom = (top + height < map->rows) ? top + height : map->rows;
+        int right = (left + width < map->cols) ? left + width : map->cols;
+
+        for (int row = top; row < bottom; row++) {
+            for (int col = left; col < right; col++) {
+                ClearBlocked(map, row, col);
+            }
+        }
+
+        int centreRow = (top + bottom) / 2, centreCol = (left + right) / 2;
+        if (i == 0) {
+            firstRow = centreRow;
+            firstCol = centreCol;
+        } else {
+            int step = (centreCol > lastCol) ? 1 : -1;
+            for (int col = lastCol; col != centreCol; col += step) {
+                ClearBlocked(map, lastRow, col);
+            }
+            step = (centreRow > lastRow) ? 1 : -1;
+            for (int row = lastRow; row != centreRow; row += step) {
+                ClearBlocked(map, row, centreCol);
+            }
+        }
+        lastRow = centreRow;
+        lastCol = centreCol;
+    }
+
+    SetEndpoints(map, firstRow, firstCol, lastRow, lastCol);
+}
+
+/**
+ * @brief: Level 2 answer, first failure case scaled up: both direct first
+ *         moves from START are blocked
+*/
+static void GenerateCorner(map_t *map, uint64_t *rng, int unused) {
+    (void)rng;
+    (void)unused;
+    int mid = (map->rows < map->cols ? map->rows : map->cols) / 2 - 1;
+
+    SetBlocked(map, mid, mid + 1);
+    SetBlocked(map, mid + 1, mid);
+    SetEndpoints(map, mid, mid, mid + 1, mid + 1);
+}
+
+/**
+ * @brief: Level 2 answer, second failure case scaled up: a diagonal wall
+ *         that sends SimpleDirections into a dead end
+*/
+static void GenerateDiagonal(map_t *map, uint64_t *rng, int unused) {
+    (void)rng;
+    (void)unused;
+    int size = (map->rows < map->cols) ? map->rows : map->cols;
+
+    for (int i = 1; i < size - 1; i++) {
+        SetBlocked(map, i, i);
+    }
+    SetBlocked(map, size - 1, size - 2);
+    SetEndpoints(map, 0, 0, size - 1, size - 1);
+}
+
+/**
+ * @brief: Level 4 answer failure case scaled up: a wall along row 1 walks
+ *         ClosestFreeNeighbour away from an END just below it
+*/
+static void GenerateTrap(map_t *map, uint64_t *rng, int unused) {
+    (void)rng;
+    (void)unused;
+    int size = (map->rows < map->cols) ? map->rows : map->cols;
+
+    for (int col = 2; col < size - 1; col++) {
+        SetBlocked(map, 1, col);
+    }
+    SetBlocked(map, size - 1, size - 2);
+    SetEndpoints(map, 0, 0, 2, 2);
+}
+
+static long CountBits(const uint64_t *plane, size_t words) {
+    long count = 0;
+    for (size_t i = 0; i < words; i++) {
+        count += __builtin_popcountll(plane[i]);
+    }
+    return count;
+}
+
+static int BenchSimpleDirections(map_t *map, search_ctx_t *ctx, long *expanded) {
+    (void)ctx;
+    int steps = SimpleDirections(map, map->startRow, map->startCol, map->endRow,
+                                 map->endCol);
+    *expanded = (steps < 0) ? -steps : steps;
+    return (steps > 0) ? steps : -1;
+}
+
+/**
+ * @brief: ClosestFreeNeighbour returns nothing, so replay its walk over the
+ *         marked PATH_SPACE cells: at each cell the first neighbour in
+ *         up/right/down/left order that was free at the time is either
+ *         END or the next cell of the walk
+*/
+static int BenchClosestFreeNeighbour(map_t *map, search_ctx_t *ctx,
+                                     long *expanded) {
+    (void)ctx;
+    int row = map->startRow, col = map->startCol, steps = 0;
+
+    ClosestFreeNeighbour(map, row, col);
+    *expanded = CountBits(map->path, map->planeWords);
+
+    for (;;) {
+        int dir = 0;
+        SetVisited(map, row, col);
+        for (; dir < 4; dir++) {
+            int nextRow = row + rowDir[dir], nextCol = col + colDir[dir];
+            if (InBounds(map, nextRow, nextCol) &&
+                (CellAt(map, nextRow, nextCol) == END_SPACE ||
+                 (IsPath(map, nextRow, nextCol) &&
+                  !IsVisited(map, nextRow, nextCol)))) {
+                break;
+            }
+        }
+        if (dir == 4) {
+            return -1;
+        }
+
+        row += rowDir[dir];
+        col += colDir[dir];
+        steps++;
+        if (row == map->endRow && col == map->endCol) {
+            return steps;
+        }
+    }
+}
+
+static int BenchFindPath(map_t *map, search_ctx_t *ctx, long *expanded) {
+    (void)ctx;
+    bool found = FindPath(map, map->startRow, map->startCol);
+    *expanded = CountBits(map->visited, map->planeWords);
+    return found ? (int)CountBits(map->path, map->planeWords) + 1 : -1;
+}
+
+static int BenchImprovedPathfinding(map_t *map, search_ctx_t *ctx,
+                                    long *expanded) {
+    (void)ctx;
+    bool found = ImprovedPathfinding(map, map->startRow, map->startCol);
+    *expanded = CountBits(map->visited, map->planeWords);
+    return found ? (int)CountBits(map->path, map->planeWords) + 1 : -1;
+}
+
+static int BenchShortestPath(map_t *map, search_ctx_t *ctx, long *expanded) {
+    int steps = ShortestPath(map, ctx, map->startRow, map->startCol,
+                             map->endRow, map->endCol);
+    *expanded = ctx->expanded;
+    return steps;
+}
 
-/**
- * @brief: Checks if possible to step into a position
- * @return: 1 if valid, 0 if invalid
-*/
-int IsValidMove(char MAP[][N], int row, int col) {
-    if (row < 0 || row >= N || col < 0 || col >= N || MAP[row][col] == BLOCK_SPACE) {
-        return 0;
-    }
+static int BenchAStar(map_t *map, search_ctx_t *ctx, long *expanded) {
+    int steps = AStarPath(map, ctx, map->startRow, map->startCol, map->endRow,
+                          map->endCol);
+    *expanded = ctx->expanded;
+    return steps;
+}
 
-    return (MAP[row][col] == EMPTY_SPACE || MAP[row][col] == END_SPACE);
+static int BenchJumpPoint(map_t *map, search_ctx_t *ctx, long *expanded) {
+    int steps = JumpPointSearch(map, ctx, map->startRow, map->startCol,
+                                map->endRow, map->endCol);
+    *expanded = ctx->expanded;
+    return steps;
 }
 
-/**
- * @brief: Attempts to step one position and marks it as part of MAP
- * @return: True if can move, false if blocked
-*/
-bool AttemptMove(char MAP[][N], int *curRow, int *curCol,
-                 int rowStep, int colStep, int *steps) {
-    int nextRow = *curRow + rowStep;
-    int nextCol = *curCol + colStep;
+static int BenchBidirectional(map_t *map, search_ctx_t *ctx, long *expanded) {
+    int steps = BidirectionalPath(map, ctx, map->startRow, map->startCol,
+                                  map->endRow, map->endCol);
+    *expanded = ctx->expanded;
+    return steps;
+}
 
-    if (!IsValidMove(MAP, nextRow, nextCol)) {
-        return false;
-    }
+static int BenchDijkstra(map_t *map, search_ctx_t *ctx, long *expanded) {
+    int cost = DijkstraPath(map, ctx, map->startRow, map->startCol,
+                            map->endRow, map->endCol);
+    *expanded = ctx->expanded;
+    return cost;
+}
 
-    *curRow = nextRow;
-    *curCol = nextCol;
+static int BenchWeightedAStar(map_t *map, search_ctx_t *ctx, long *expanded) {
+    int cost = WeightedAStarPath(map, ctx, map->startRow, map->startCol,
+                                 map->endRow, map->endCol);
+    *expanded = ctx->expanded;
+    return cost;
+}
 
-    if (MAP[nextRow][nextCol] == EMPTY_SPACE) { 
-        MAP[nextRow][nextCol] = PATH_SPACE;
-    }
+static int BenchBitset(map_t *map, search_ctx_t *ctx, long *expanded) {
+    (void)ctx;
+    bitset_bfs_t *bfs = CreateBitsetBfs(map);
+    int steps = BitsetDistance(bfs, map->startRow, map->startCol, map->endRow,
+                               map->endCol);
+    *expanded = CountBits(bfs->reached, (size_t)(bfs->rows + 2) * bfs->stride);
+    FreeBitsetBfs(bfs);
+    return steps;
+}
 
-    (*steps)++;
-    return true;
+static int BenchParallel(map_t *map, search_ctx_t *ctx, long *expanded) {
+    (void)ctx;
+    parallel_bfs_t *bfs = CreateParallelBfs(map, 0);
+    int steps = ParallelDistance(bfs, map->startRow, map->startCol,
+                                 map->endRow, map->endCol);
+    *expanded = bfs->reached;
+    FreeParallelBfs(bfs);
+    return steps;
 }
 
-/**
- * @brief: Checks all 4 neighbour positions (up, right, down, left) 
- * @return: True if stuck, false if at least 1 valid move exists
-*/
-bool IsStuck(char MAP[][N], int curRow, int curCol) {   
-    for (int i = 0; i < 4; i++) {
-        if (IsValidMove(MAP, curRow + rowDir[i], curCol + colDir[i])) {
-            return false;
-        }
-    }
+static int BenchDStar(map_t *map, search_ctx_t *ctx, long *expanded) {
+    (void)ctx;
+    dstar_t *dstar = CreateDStar(map, map->startRow, map->startCol, map->endRow,
+                                 map->endCol);
+    int steps = DStarPlan(dstar);
+    *expanded = dstar->expanded;
+    FreeDStar(dstar);
+    return steps;
+}
 
-    return true;
+static int BenchHierarchical(map_t *map, search_ctx_t *ctx, long *expanded) {
+    (void)ctx;
+    hpa_t *hpa = BuildHierarchy(map);
+    int steps = HierarchicalPath(hpa, map->startRow, map->startCol, map->endRow,
+                                 map->endCol, false);
+    *expanded = hpa->expanded;
+    FreeHierarchy(hpa);
+    return steps;
 }
 
 /**
- * @brief: Recursive pathfinding with backtracking
- *         Base case: return true if on END_SPACE, false otherwise
- *         Recursive case: if position is EMPTY_SPACE, mark as VISITED_SPACE 
- *          recurse on first valid neighbour, if recursive call returns true,
- *          mark as PATH_SPACE and return true        
- * @return: True if found path to END_SPACE, false otherwise
+ * @brief: Generates every map family at every size from one seed and times
+ *         each solver on it, printing one CSV row per run. Timings cover
+ *         per-map setup (bitset planes, hierarchy, D* state) but not the
+ *         reusable search context
 */
-bool FindPath(char MAP[][N], int curRow, int curCol, bool visited[][N]) {
-    if (MAP[curRow][curCol] == END_SPACE) {
-        return true;
-    }
-
-    visited[curRow][curCol] = true;
+void RunBenchmark(uint64_t seed, int layout) {
+    static const bench_family_t families[] = {
+        {"random10", GenerateRandom, 10}, {"random25", GenerateRandom, 25},
+        {"random40", GenerateRandom, 40}, {"maze", GenerateMaze, 0},
+        {"rooms", GenerateRooms, 0},      {"corner", GenerateCorner, 0},
+        {"diagonal", GenerateDiagonal, 0}, {"trap", GenerateTrap, 0},
+    };
+    static const bench_solver_t solvers[] = {
+        {"SimpleDirections", BenchSimpleDirections},
+        {"ClosestFreeNeighbour", BenchClosestFreeNeighbour},
+        {"FindPath", BenchFindPath},
+        {"ImprovedPathfinding", BenchImprovedPathfinding},
+        {"ShortestPath", BenchShortestPath},
+        {"AStarPath", BenchAStar},
+        {"JumpPointSearch", BenchJumpPoint},
+        {"BidirectionalPath", BenchBidirectional},
+        {"DijkstraPath", BenchDijkstra},
+        {"WeightedAStarPath", BenchWeightedAStar},
+        {"BitsetDistance", BenchBitset},
+        {"ParallelDistance", BenchParallel},
+        {"DStarLite", BenchDStar},
+        {"HierarchicalPath", BenchHierarchical},
+    };
+    static const int sizes[] = {64, 256, 1024};
+    int familyCount = sizeof(families) / sizeof(families[0]);
+    int solverCount = sizeof(solvers) / sizeof(solvers[0]);
+    int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
 
-    bool isStart = (MAP[curRow][curCol] == START_SPACE);
+    printf("family,size,solver,wall_ns,expanded,path_len\n");
+    for (int f = 0; f < familyCount; f++) {
+        for (int s = 0; s < sizeCount; s++) {
+            uint64_t rng = seed * 0x9e3779b97f4a7c15ull + (uint64_t)f * 131 + s + 1;
+            map_t *map = CreateMap(sizes[s], sizes[s], layout);
+            search_ctx_t *ctx = CreateSearchContext(sizes[s] * sizes[s]);
 
-    if (!isStart && MAP[curRow][curCol] == EMPTY_SPACE) {
-        MAP[curRow][curCol] = VISITED_SPACE;
-    }
+            families[f].generate(map, &rng, families[f].param);
+            map->components = BuildComponents(map);
 
-    for (int i = 0; i < 4; i++) {
-        int nextRow = curRow + rowDir[i];
-        int nextCol = curCol + colDir[i];
-
-        if (nextRow >= 0 && nextRow < N && 
-            nextCol >= 0 && nextCol < N &&
-            MAP[nextRow][nextCol] != BLOCK_SPACE &&
-            !visited[nextRow][nextCol]) {
-            if (FindPath(MAP, nextRow, nextCol, visited)) {
-                if (!isStart && MAP[curRow][curCol] == VISITED_SPACE) {
-                    MAP[curRow][curCol] = PATH_SPACE;
-                }
+            for (int k = 0; k < solverCount; k++) {
+                long expanded = 0;
+                RefreshMap(map);
+                long long begin = NowNanoseconds();
+                int pathLength = solvers[k].run(map, ctx, &expanded);
+                long long elapsed = NowNanoseconds() - begin;
 
-                return true;
+                printf("%s,%d,%s,%lld,%ld,%d\n", families[f].name, sizes[s],
+                       solvers[k].name, elapsed, expanded, pathLength);
             }
+
+            FreeSearchContext(ctx);
+            FreeMap(map);
         }
     }
-
-    return false;
 }
 
 /*==========================================================*
 *                        CODE START                         *
 *==========================================================*/
 int main(int argc, char *argv[]) {
-    if (argc != 3 || strcmp(argv[1], "-level")) {
+    int level = 0, threads = 0, layout = LAYOUT_ROWMAJOR;
+    bool batch = false, bench = false, showStats = false;
+    uint64_t seed = 0;
+    size_t fieldBytes = 0;
+    const char *mapFile = NULL, *convertFile = NULL;
+    int render = RENDER_FULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-level") && i + 1 < argc) {
+            level = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-batch")) {
+            batch = true;
+        } else if (!strcmp(argv[i], "-stats")) {
+            showStats = true;
+        } else if (!strcmp(argv[i], "-bench") && i + 1 < argc) {
+            bench = true;
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "-threads") && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-fields") && i + 1 < argc) {
+            fieldBytes = (size_t)atoi(argv[++i]) << 20;
+        } else if (!strcmp(argv[i], "-map") && i + 1 < argc) {
+            mapFile = argv[++i];
+        } else if (!strcmp(argv[i], "-convert") && i + 1 < argc) {
+            convertFile = argv[++i];
+        } else if (!strcmp(argv[i], "-render") && i + 1 < argc) {
+            i++;
+            if (!strcmp(argv[i], "diff")) {
+                render = RENDER_DIFF;
+            } else if (!strcmp(argv[i], "coords")) {
+                render = RENDER_COORDS;
+            } else if (strcmp(argv[i], "full")) {
+                level = 0;
+                batch = bench = false;
+                convertFile = NULL;
+                break;
+            }
+        } else if (!strcmp(argv[i], "-layout") && i + 1 < argc) {
+            i++;
+            if (!strcmp(argv[i], "tiled")) {
+                layout = LAYOUT_TILED;
+            } else if (!strcmp(argv[i], "morton")) {
+                layout = LAYOUT_MORTON;
+            } else if (strcmp(argv[i], "rowmajor")) {
+                level = 0;
+                batch = bench = false;
+                convertFile = NULL;
+                break;
+            }
+        } else {
+            level = 0;
+            batch = bench = false;
+            convertFile = NULL;
+            break;
+        }
+    }
+    if (bench) {
+        RunBenchmark(seed, layout);
+        return 0;
+    }
+    if (level == 0 && !batch && convertFile == NULL) {
         printf(
             "You must run this program specifying the level to run as an "
             "argument\n");
+        printf("  or -batch [-threads T] [-fields MB] to answer the queries "
+               "after the map\n");
+        printf("  or -convert FILE to save the text map as a binary map\n");
+        printf("  or -bench SEED to time every solver on generated maps\n");
+        printf("  (-map FILE reads a binary map instead of the text map)\n");
+        printf("  (-layout rowmajor|tiled|morton picks the map storage order)\n");
+        printf("  (-render full|diff|coords prints whole maps, changed cells "
+               "or path cells)\n");
+        printf("  (-stats prints the solver counters after the level)\n");
+        printf("  (-threads T also sets the level 14 BFS threads)\n");
+        printf("  (level 16 reads K and K \"startRow startCol endRow endCol\" "
+               "agent lines after the map)\n");
+        printf("  (\"costs K\" and K \"row col cost\" lines after the blocks add "
+               "terrain costs)\n");
         exit(EXIT_FAILURE);
     }
-    int level = atoi(argv[2]);
 
-    char MAP[N][N];
     int startRow, startColumn, endRow, endColumn;
+    search_stats_t stats = {.pathLength = -1};
+    map_t *map;
 
-    ClearMap(MAP);
-    FillMap(MAP, &startRow, &startColumn, &endRow, &endColumn);
+    if (mapFile != NULL) {
+        map = LoadBinaryMap(mapFile, layout);
+        startRow = map->startRow;
+        startColumn = map->startCol;
+        endRow = map->endRow;
+        endColumn = map->endCol;
+    } else {
+        map = ReadMapDimensions(layout);
+        ClearMap(map);
+        FillMap(map, &startRow, &startColumn, &endRow, &endColumn);
+        ReadCosts(map);
+    }
+    if (showStats) {
+        map->stats = &stats;
+    }
+    if (render != RENDER_FULL) {
+        map->renderer = CreateRenderer(render);
+    }
 
-    if (level == 1) {
-        Level01(MAP, startRow, startColumn, endRow, endColumn);
+    if (convertFile != NULL) {
+        WriteBinaryMap(map, convertFile);
+    } else if (batch) {
+        RunBatch(map, threads, fieldBytes);
+    } else if (level == 1) {
+        Level01(map, startRow, startColumn, endRow, endColumn);
     } else if (level == 2) {
-        Level02(MAP, startRow, startColumn, endRow, endColumn);
+        Level02(map, startRow, startColumn, endRow, endColumn);
     } else if (level == 3) {
-        Level03(MAP, startRow, startColumn);
+        Level03(map, startRow, startColumn);
     } else if (level == 4) {
-        Level04(MAP, startRow, startColumn);
+        Level04(map, startRow, startColumn);
+    } else if (level == 5) {
+        Level05(map, startRow, startColumn, endRow, endColumn);
+    } else if (level == 6) {
+        Level06(map, startRow, startColumn, endRow, endColumn);
+    } else if (level == 7) {
+        Level07(map, startRow, startColumn, endRow, endColumn);
+    } else if (level == 8) {
+        Level08(map, startRow, startColumn, endRow, endColumn);
+    } else if (level == 9) {
+        Level09(map, startRow, startColumn, endRow, endColumn);
+    } else if (level == 10) {
+        Level10(map, startRow, startColumn, endRow, endColumn);
+    } else if (level == 11) {
+        Level11(map, startRow, startColumn, endRow, endColumn);
+    } else if (level == 12) {
+        Level12(map, startRow, startColumn, endRow, endColumn);
+    } else if (level == 13) {
+        Level13(map, startRow, startColumn, endRow, endColumn);
+    } else if (level == 14) {
+        Level14(map, startRow, startColumn, endRow, endColumn, threads);
+    } else if (level == 15) {
+        Level15(map, startRow, startColumn, endRow, endColumn);
+    } else if (level == 16) {
+        Level16(map);
+    }
+    if (showStats && level != 0 && !batch && convertFile == NULL) {
+        PrintStats(&stats);
     }
 
+    FreeMap(map);
     return 0;
 }
 
@@ -194,27 +5346,40 @@ int main(int argc, char *argv[]) {
 *==========================================================*/
 /**
  * @brief: Level 1 Task 2 - Prints out the map to the terminal screen
+ *         The frame is built in one buffer and written with a single
+ *         write() (one per RENDER_BUFFER_BYTES on huge maps) instead of
+ *         one printf per cell; -render diff and -render coords print
+ *         only the changed cells or the path cells instead
 **/
-void PrintMap(char MAP[][N]) {
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) 
-            printf("[%c]", MAP[i][j]);
-        printf("\n");
+void PrintMap(const map_t *map) {
+    int mode = (map->renderer != NULL) ? map->renderer->mode : RENDER_FULL;
+    frame_t frame = {NULL, 0, 0};
+
+    /* Keep the frame after anything printf still holds */
+    fflush(stdout);
+    if (mode == RENDER_DIFF) {
+        RenderDiff(map, &frame);
+    } else if (mode == RENDER_COORDS) {
+        RenderCoords(map, &frame);
+    } else {
+        RenderFull(map, &frame);
     }
+    FlushFrame(&frame);
+    free(frame.data);
 }
 
-/** 
+/**
  * @brief: Level 1 Task 1 & 3 - Reads in the map data from the test file,
            saves the starting and ending locations
 **/
-void FillMap(char MAP[][N], int *startRow, int *startColumn, int *endRow,
-             int *endColumn) {              
+void FillMap(map_t *map, int *startRow, int *startColumn, int *endRow,
+             int *endColumn) {
     int sRow, sCol, eRow, eCol, blocks;
-    
+
     if (scanf("%d %d", &sRow, &sCol) != 2) {
         fprintf(stderr, "Error reading starting position\n");
         exit(EXIT_FAILURE);
-    } 
+    }
 
     if (scanf("%d %d", &eRow, &eCol) != 2) {
         fprintf(stderr, "Error reading ending position\n");
@@ -225,12 +5390,17 @@ void FillMap(char MAP[][N], int *startRow, int *startColumn, int *endRow,
         fprintf(stderr, "Error reading number of blocks\n");
         exit(EXIT_FAILURE);
     }
-    
+
+    if (!InBounds(map, sRow, sCol) || !InBounds(map, eRow, eCol)) {
+        fprintf(stderr, "Error: start or end lies outside the map\n");
+        exit(EXIT_FAILURE);
+    }
+
     *startRow = sRow;
     *startColumn = sCol;
     *endRow = eRow;
     *endColumn = eCol;
-    
+
     for (int i = 0; i < blocks; i++) {
         int blockRow, blockCol;
 
@@ -239,36 +5409,40 @@ void FillMap(char MAP[][N], int *startRow, int *startColumn, int *endRow,
             exit(EXIT_FAILURE);
         }
 
-        if (blockRow >= 0 && blockRow < N && blockCol >= 0 && blockCol < N) {
-            MAP[blockRow][blockCol] = BLOCK_SPACE;
+        if (InBounds(map, blockRow, blockCol) &&
+            !(blockRow == sRow && blockCol == sCol) &&
+            !(blockRow == eRow && blockCol == eCol)) {
+            SetBlocked(map, blockRow, blockCol);
         }
     }
 
-    MAP[sRow][sCol] = START_SPACE;
-    MAP[eRow][eCol] = END_SPACE;
+    map->startRow = sRow;
+    map->startCol = sCol;
+    map->endRow = eRow;
+    map->endCol = eCol;
 }
 
-/** 
+/**
  * @brief: Level 2 - Finds the correct row then the correct column
  *         Assumption: START_SPACE =/= END_SPACE
  *         Exception: Stuck at 0 step but (-0)==0, later specify in Level02
  * @return: Number of steps taken, positive if reached the end, negative if stuck
 **/
-int SimpleDirections(char MAP[][N], int startRow, int startColumn, int endRow,
+int SimpleDirections(map_t *map, int startRow, int startColumn, int endRow,
                      int endColumn) {
     int curRow = startRow;
     int curCol = startColumn;
     int steps = 0;
-    
+
     int rowStep = (endRow > curRow) ? 1 : -1;
     while (curRow != endRow) {
-        if (AttemptMove(MAP, &curRow, &curCol, rowStep, 0, &steps)) {
+        if (AttemptMove(map, &curRow, &curCol, rowStep, 0, &steps)) {
             continue;
         }
 
         int colStep = (endColumn > curCol) ? 1 : -1;
-        if (AttemptMove(MAP, &curRow, &curCol, 0, colStep, &steps)) {
-            continue; 
+        if (AttemptMove(map, &curRow, &curCol, 0, colStep, &steps)) {
+            continue;
         }
 
         return -steps;
@@ -276,90 +5450,82 @@ int SimpleDirections(char MAP[][N], int startRow, int startColumn, int endRow,
 
     int colStep = (endColumn > curCol) ? 1 : -1;
     while (curCol != endColumn) {
-        if (AttemptMove(MAP, &curRow, &curCol, 0, colStep, &steps)) {
+        if (AttemptMove(map, &curRow, &curCol, 0, colStep, &steps)) {
             continue;
         }
 
-        if (AttemptMove(MAP, &curRow, &curCol, 1, 0, &steps) ||
-            AttemptMove(MAP, &curRow, &curCol, -1, 0, &steps)) {
+        if (AttemptMove(map, &curRow, &curCol, 1, 0, &steps) ||
+            AttemptMove(map, &curRow, &curCol, -1, 0, &steps)) {
             continue;
         }
         return -steps;
-    }  
+    }
 
     return steps;
 }
 
-/** 
- * @brief: Level 3 - Recursively finds and marks a path from START_SPACE to END_SPACE
- *         Attempts one move per call in order: up, right, down, left
- *         Base case: return if on END_SPACE
- *         Recursive case: if a neighbour is END_SPACE, recurse,
- *         if EMPTY_SPACE, mark as PATH_SPACE, recurse 
- *         Restore START_SPACE if no path found
+/**
+ * @brief: Level 3 - Walks from START_SPACE towards END_SPACE, one move per
+ *         step in the order: up, right, down, left
+ *         Stops when a neighbour is END_SPACE; otherwise moves to the first
+ *         EMPTY_SPACE neighbour and marks it as PATH_SPACE, until none is left
+ *         The walk never branches, so a plain loop replaces the old tail
+ *         recursion and no stack is needed
+ *         START_SPACE is stored as coordinates, so it never needs restoring
  */
-void ClosestFreeNeighbour(char MAP[][N], int currentRow, int currentColumn) {
-    if (MAP[currentRow][currentColumn] == END_SPACE) {
-        return;
-    }
+void ClosestFreeNeighbour(map_t *map, int currentRow, int currentColumn) {
+    int walked = 1;       // Cells on the walk, START_SPACE included
+    int pathLength = -1;
 
-    bool isStart = (MAP[currentRow][currentColumn] == START_SPACE);
-
-    for (int dir = 0; dir < 4; dir++) {
-        int nextRow = currentRow + rowDir[dir];
-        int nextCol = currentColumn + colDir[dir];
-
-        if (nextRow < 0 || nextRow >= N || nextCol < 0 || nextCol >= N) {
-            continue;
-        }
-
-        if (MAP[nextRow][nextCol] == END_SPACE) {
-            ClosestFreeNeighbour(MAP, nextRow, nextCol);
-            if (isStart) {
-                MAP[currentRow][currentColumn] = START_SPACE;
-            } 
+    if (CellAt(map, currentRow, currentColumn) == END_SPACE) {
+        pathLength = 0;
+    }
 
-            return;
-        }
+    while (pathLength < 0) {
+        int dir = 0;
+        for (; dir < 4; dir++) {
+            int nextRow = currentRow + rowDir[dir];
+            int nextCol = currentColumn + colDir[dir];
 
-        if (MAP[nextRow][nextCol] == EMPTY_SPACE) {
-            MAP[nextRow][nextCol] = PATH_SPACE;
-            if (!isStart) {
-                MAP[currentRow][currentColumn] = PATH_SPACE;
+            if (!InBounds(map, nextRow, nextCol)) {
+                continue;
             }
 
-            ClosestFreeNeighbour(MAP, nextRow, nextCol);
-            if (isStart) {
-                MAP[currentRow][currentColumn] = START_SPACE;
+            char next = CellAt(map, nextRow, nextCol);
+            if (next == END_SPACE) {
+                pathLength = walked;
+                break;
             }
-
-            return;
+            if (next == EMPTY_SPACE) {
+                break;
+            }
+        }
+        if (dir == 4 || pathLength >= 0) {
+            break;
         }
+
+        currentRow += rowDir[dir];
+        currentColumn += colDir[dir];
+        SetPath(map, currentRow, currentColumn);
+        walked++;
     }
 
-    if (isStart) {
-        MAP[currentRow][currentColumn] = START_SPACE;
+    if (map->stats != NULL) {
+        map->stats->visited = walked;
+        map->stats->maxDepth = walked;
+        map->stats->pathLength = pathLength;
     }
 }
 
-/** 
+/**
  * @brief: Level 4 Bonus - Implements depth-first backtracking from START_SPACE to END_SPACE
  * @return: True if path found, false otherwise
  */
-bool ImprovedPathfinding(char MAP[][N], int currentRow, int currentColumn) {
-    bool visited[N][N];
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            visited[i][j] = false;
-        }
-    }
+bool ImprovedPathfinding(map_t *map, int currentRow, int currentColumn) {
+    memset(map->visited, 0, PlaneBytes(map));
 
-    if (FindPath(MAP, currentRow, currentColumn, visited)) {
-        return true;
-    } else {
-        printf("No path found\n");
-        return false;
-    }
+    return MayReach(map, currentRow, currentColumn, map->endRow, map->endCol) &&
+           FindPath(map, currentRow, currentColumn);
 }
 
 /*==========================================================*
@@ -371,24 +5537,29 @@ void LevelHeader(int LevelNum) {
     printf("=================================\n");
 }
 // Level01
-void Level01(char MAP[][N], int startRow, int startColumn, int endRow,
+void Level01(map_t *map, int startRow, int startColumn, int endRow,
              int endColumn) {
     LevelHeader(1);
-    PrintMap(MAP);
+    PrintMap(map);
     printf("The starting position is at MAP[%d][%d]\n", startRow, startColumn);
     printf("The ending position is at MAP[%d][%d]\n", endRow, endColumn);
 }
 
 // Level02
-void Level02(char MAP[][N], int startRow, int startColumn, int endRow,
+void Level02(map_t *map, int startRow, int startColumn, int endRow,
              int endColumn) {
     LevelHeader(2);
-    int steps = SimpleDirections(MAP, startRow, startColumn, endRow, endColumn);
+    StatsBegin(map);
+    int steps = SimpleDirections(map, startRow, startColumn, endRow, endColumn);
+    StatsEnd(map);
+    bool reached = steps > 0 ||
+                   (steps == 0 && !IsStuck(map, startRow, startColumn));
+    RecordStats(map, (steps < 0) ? -steps : steps, 0, reached ? steps : -1);
 
     if (steps > 0) {
         printf("SimpleDirections took %d steps to find the goal.\n\n", steps);
     } else if (steps == 0) {
-        if(IsStuck(MAP, startRow, startColumn)) {
+        if(IsStuck(map, startRow, startColumn)) {
             printf("SimpleDirections took %d steps and got stuck.\n\n", steps);
         } else {
             printf("SimpleDirections took %d steps to find the goal.\n\n", -steps);
@@ -397,45 +5568,482 @@ void Level02(char MAP[][N], int startRow, int startColumn, int endRow,
         printf("SimpleDirections took %d steps and got stuck.\n\n", -steps);
     }
 
-    PrintMap(MAP);
+    PrintMap(map);
 }
 
 // Level03
-void Level03(char MAP[][N], int startRow, int startColumn) {
+void Level03(map_t *map, int startRow, int startColumn) {
     LevelHeader(3);
-    RefreshMap(MAP);
-    ClosestFreeNeighbour(MAP, startRow, startColumn);
-    PrintMap(MAP);
+    RefreshMap(map);
+    StatsBegin(map);
+    ClosestFreeNeighbour(map, startRow, startColumn);
+    StatsEnd(map);
+    PrintMap(map);
 }
 
 // Level04
-void Level04(char MAP[][N], int startRow, int startColumn) {
+void Level04(map_t *map, int startRow, int startColumn) {
     LevelHeader(4);
-    RefreshMap(MAP);
-    ImprovedPathfinding(MAP, startRow, startColumn);
-    PrintMap(MAP);
+    RefreshMap(map);
+    StatsBegin(map);
+    bool found = ImprovedPathfinding(map, startRow, startColumn);
+    StatsEnd(map);
+    if (!found) {
+        printf("No path found\n");
+    }
+    PrintMap(map);
 }
 
-// Function to clear the map
-void ClearMap(char MAP[][N]) {
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            MAP[i][j] = EMPTY_SPACE;
+// Level05
+void Level05(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn) {
+    LevelHeader(5);
+    RefreshMap(map);
+
+    search_ctx_t *ctx = CreateSearchContext(map->rows * map->cols);
+    StatsBegin(map);
+    int steps = ShortestPath(map, ctx, startRow, startColumn, endRow, endColumn);
+    StatsEnd(map);
+    RecordContextStats(map, ctx, steps);
+
+    MarkSearchVisited(map, ctx);
+    if (steps >= 0) {
+        MarkSearchPath(map, ctx, endRow, endColumn);
+        printf("ShortestPath took %d steps to find the goal.\n", steps);
+    } else {
+        printf("No path found\n");
+    }
+    printf("ShortestPath expanded %ld cells.\n\n", ctx->expanded);
+
+    PrintMap(map);
+    FreeSearchContext(ctx);
+}
+
+// Level06
+void Level06(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn) {
+    LevelHeader(6);
+    RefreshMap(map);
+
+    search_ctx_t *ctx = CreateSearchContext(map->rows * map->cols);
+    StatsBegin(map);
+    int steps = AStarPath(map, ctx, startRow, startColumn, endRow, endColumn);
+    StatsEnd(map);
+    RecordContextStats(map, ctx, steps);
+
+    MarkSearchVisited(map, ctx);
+    if (steps >= 0) {
+        MarkSearchPath(map, ctx, endRow, endColumn);
+        printf("AStarPath took %d steps to find the goal.\n", steps);
+    } else {
+        printf("No path found\n");
+    }
+    printf("AStarPath expanded %ld cells.\n\n", ctx->expanded);
+
+    PrintMap(map);
+    FreeSearchContext(ctx);
+}
+
+// Level07
+void Level07(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn) {
+    LevelHeader(7);
+    RefreshMap(map);
+
+    search_ctx_t *ctx = CreateSearchContext(map->rows * map->cols);
+    StatsBegin(map);
+    int steps = JumpPointSearch(map, ctx, startRow, startColumn, endRow,
+                                endColumn);
+    StatsEnd(map);
+    RecordContextStats(map, ctx, steps);
+
+    MarkSearchVisited(map, ctx);
+    if (steps >= 0) {
+        MarkJumpPath(map, ctx, endRow, endColumn);
+        printf("JumpPointSearch took %d steps to find the goal.\n", steps);
+    } else {
+        printf("No path found\n");
+    }
+    printf("JumpPointSearch expanded %ld jump points.\n\n", ctx->expanded);
+
+    PrintMap(map);
+    FreeSearchContext(ctx);
+}
+
+// Level08
+void Level08(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn) {
+    LevelHeader(8);
+    RefreshMap(map);
+
+    search_ctx_t *ctx = CreateSearchContext(map->rows * map->cols);
+    StatsBegin(map);
+    int steps = BidirectionalPath(map, ctx, startRow, startColumn, endRow,
+                                  endColumn);
+    StatsEnd(map);
+    RecordContextStats(map, ctx, steps);
+
+    MarkSearchVisited(map, ctx);
+    if (steps >= 0) {
+        MarkSearchPath(map, ctx, endRow, endColumn);
+        printf("BidirectionalPath took %d steps to find the goal.\n", steps);
+    } else {
+        printf("No path found\n");
+    }
+    printf("BidirectionalPath expanded %ld cells.\n\n", ctx->expanded);
+
+    PrintMap(map);
+    FreeSearchContext(ctx);
+}
+
+// Level09
+void Level09(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn) {
+    LevelHeader(9);
+    RefreshMap(map);
+
+    StatsBegin(map);
+    bitset_bfs_t *bfs = CreateBitsetBfs(map);
+    int steps = BitsetDistance(bfs, startRow, startColumn, endRow, endColumn);
+    StatsEnd(map);
+    long reached = 0;
+
+    for (int row = 0; row < map->rows; row++) {
+        const uint64_t *bits = BitsetRow(bfs, bfs->reached, row);
+        for (int w = 0; w < map->rowWords; w++) {
+            reached += __builtin_popcountll(bits[w]);
+            if (map->layout == LAYOUT_ROWMAJOR) {
+                map->visited[(size_t)row * map->rowWords + w] = bits[w];
+                continue;
+            }
+            for (uint64_t rest = bits[w]; rest; rest &= rest - 1) {
+                SetVisited(map, row, w * WORD_BITS + __builtin_ctzll(rest));
+            }
         }
     }
+
+    if (steps >= 0) {
+        printf("BitsetDistance took %d steps to find the goal.\n", steps);
+    } else {
+        printf("No path found\n");
+    }
+    printf("BitsetDistance reached %ld cells.\n\n", reached);
+    RecordStats(map, reached, 0, steps);
+
+    PrintMap(map);
+    FreeBitsetBfs(bfs);
 }
 
-// Function to make printing out a "clean" map easier
-void RefreshMap(char MAP[][N]) {
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            char currentNode = MAP[i][j];
-            if (!(currentNode == START_SPACE || currentNode == END_SPACE ||
-                  currentNode == BLOCK_SPACE)) {
-                MAP[i][j] = EMPTY_SPACE;
+// Level10
+void Level10(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn) {
+    LevelHeader(10);
+    RefreshMap(map);
+
+    StatsBegin(map);
+    dstar_t *dstar = CreateDStar(map, startRow, startColumn, endRow, endColumn);
+    int steps = DStarPlan(dstar);
+    StatsEnd(map);
+    RecordStats(map, dstar->expanded, 0, steps);
+
+    if (steps >= 0) {
+        printf("DStarLite took %d steps to find the goal.\n", steps);
+    } else {
+        printf("No path found\n");
+    }
+    printf("DStarLite expanded %ld cells.\n\n", dstar->expanded);
+
+    /* Replan after each "block row col" / "unblock row col" event */
+    char word[16];
+    int row, col;
+    for (int event = 1; scanf("%15s %d %d", word, &row, &col) == 3; event++) {
+        if (strcmp(word, "block") && strcmp(word, "unblock")) {
+            fprintf(stderr, "Error reading block event #%d\n", event);
+            exit(EXIT_FAILURE);
+        }
+        DStarSetBlocked(dstar, row, col, word[0] == 'b');
+        steps = DStarPlan(dstar);
+        printf("%s %d %d: ", word, row, col);
+        if (steps >= 0) {
+            printf("%d steps", steps);
+        } else {
+            printf("no path");
+        }
+        printf(", %ld cells expanded\n", dstar->expanded);
+    }
+    printf("\n");
+
+    MarkDStarPath(map, dstar);
+    PrintMap(map);
+    FreeDStar(dstar);
+}
+
+// Level11
+void Level11(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn) {
+    LevelHeader(11);
+    RefreshMap(map);
+
+    map->components = BuildComponents(map);
+    StatsBegin(map);
+    hpa_t *hpa = BuildHierarchy(map);
+    int steps = HierarchicalPath(hpa, startRow, startColumn, endRow, endColumn,
+                                 false);
+    StatsEnd(map);
+    RecordStats(map, hpa->expanded, 0, steps);
+
+    printf("HierarchicalPath built %d entrance nodes over %d clusters.\n",
+           hpa->nodeCount - hpa->freeNodes.count,
+           hpa->clusterRows * hpa->clusterCols);
+    if (steps >= 0) {
+        printf("HierarchicalPath took %d steps to find the goal.\n", steps);
+    } else {
+        printf("No path found\n");
+    }
+    printf("HierarchicalPath expanded %ld abstract nodes.\n\n", hpa->expanded);
+
+    /* Re-query after each "block row col" / "unblock row col" event; only
+     * the clusters around the changed cell are rebuilt */
+    char word[16];
+    int row, col;
+    for (int event = 1; scanf("%15s %d %d", word, &row, &col) == 3; event++) {
+        if (strcmp(word, "block") && strcmp(word, "unblock")) {
+            fprintf(stderr, "Error reading block event #%d\n", event);
+            exit(EXIT_FAILURE);
+        }
+        bool blocked = word[0] == 'b';
+        bool endpoint = (row == startRow && col == startColumn) ||
+                        (row == endRow && col == endColumn);
+
+        if (InBounds(map, row, col) && !endpoint &&
+            IsBlocked(map, row, col) != blocked) {
+            if (blocked) {
+                AddBlock(map, row, col);
+            } else {
+                RemoveBlock(map, row, col);
+            }
+            HierarchyCellChanged(hpa, row, col);
+        }
+
+        steps = HierarchicalPath(hpa, startRow, startColumn, endRow, endColumn,
+                                 false);
+        printf("%s %d %d: ", word, row, col);
+        if (steps >= 0) {
+            printf("%d steps", steps);
+        } else {
+            printf("no path");
+        }
+        printf(", %ld abstract nodes expanded\n", hpa->expanded);
+    }
+    printf("\n");
+
+    HierarchicalPath(hpa, startRow, startColumn, endRow, endColumn, true);
+    PrintMap(map);
+    FreeHierarchy(hpa);
+}
+
+// Level12
+void Level12(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn) {
+    LevelHeader(12);
+    RefreshMap(map);
+
+    search_ctx_t *ctx = CreateSearchContext(map->rows * map->cols);
+    StatsBegin(map);
+    int cost = DijkstraPath(map, ctx, startRow, startColumn, endRow,
+                            endColumn);
+    StatsEnd(map);
+
+    MarkSearchVisited(map, ctx);
+    int steps = -1;
+    if (cost >= 0) {
+        steps = MarkSearchPath(map, ctx, endRow, endColumn);
+        printf("DijkstraPath found a path of cost %d in %d steps.\n", cost,
+               steps);
+    } else {
+        printf("No path found\n");
+    }
+    printf("DijkstraPath expanded %ld cells.\n\n", ctx->expanded);
+    RecordContextStats(map, ctx, steps);
+
+    PrintMap(map);
+    FreeSearchContext(ctx);
+}
+
+// Level13
+void Level13(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn) {
+    LevelHeader(13);
+    RefreshMap(map);
+
+    search_ctx_t *ctx = CreateSearchContext(map->rows * map->cols);
+    StatsBegin(map);
+    int cost = WeightedAStarPath(map, ctx, startRow, startColumn, endRow,
+                                 endColumn);
+    StatsEnd(map);
+
+    MarkSearchVisited(map, ctx);
+    int steps = -1;
+    if (cost >= 0) {
+        steps = MarkSearchPath(map, ctx, endRow, endColumn);
+        printf("WeightedAStarPath found a path of cost %d in %d steps.\n",
+               cost, steps);
+    } else {
+        printf("No path found\n");
+    }
+    printf("WeightedAStarPath expanded %ld cells.\n\n", ctx->expanded);
+    RecordContextStats(map, ctx, steps);
+
+    PrintMap(map);
+    FreeSearchContext(ctx);
+}
+
+// Level14
+void Level14(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn, int threads) {
+    LevelHeader(14);
+    RefreshMap(map);
+
+    StatsBegin(map);
+    parallel_bfs_t *bfs = CreateParallelBfs(map, threads);
+    int steps = ParallelDistance(bfs, startRow, startColumn, endRow,
+                                 endColumn);
+    StatsEnd(map);
+    RecordStats(map, bfs->reached, 0, steps);
+
+    for (size_t w = 0; w < bfs->words; w++) {
+        for (uint64_t rest = bfs->visited[w]; rest; rest &= rest - 1) {
+            int cell = (int)(w * WORD_BITS + __builtin_ctzll(rest));
+            SetVisited(map, cell / map->cols, cell % map->cols);
+        }
+    }
+
+    if (steps >= 0) {
+        printf("ParallelDistance took %d steps to find the goal.\n", steps);
+    } else {
+        printf("No path found\n");
+    }
+    printf("ParallelDistance reached %ld cells in %d levels (%d bottom-up) "
+           "on %d threads.\n\n", bfs->reached, bfs->levels,
+           bfs->bottomUpLevels, bfs->threads);
+
+    PrintMap(map);
+    FreeParallelBfs(bfs);
+}
+
+// Level15
+void Level15(map_t *map, int startRow, int startColumn, int endRow,
+             int endColumn) {
+    LevelHeader(15);
+    RefreshMap(map);
+
+    StatsBegin(map);
+    rle_map_t *rle = BuildRleMap(map);
+    bool *seen = malloc(((size_t)rle->runCount + 1) * sizeof(bool));
+    if (seen == NULL) {
+        fprintf(stderr, "Error allocating run flags\n");
+        exit(EXIT_FAILURE);
+    }
+    int runsExpanded;
+    int chain = IntervalReach(rle, startRow, startColumn, endRow, endColumn,
+                              seen, &runsExpanded);
+    StatsEnd(map);
+    // path_length counts the runs on the chain to END, not steps
+    RecordStats(map, runsExpanded, 0, chain);
+
+    for (int run = 0; run < rle->runCount; run++) {
+        for (int col = rle->runs[run].first; seen[run] && col <= rle->runs[run].last;
+             col++) {
+            SetVisited(map, rle->runs[run].row, col);
+        }
+    }
+
+    printf("RleMap holds %d free runs in %zu bytes.\n", rle->runCount,
+           (size_t)rle->runCount * sizeof(interval_t) +
+           ((size_t)rle->rows + 1) * sizeof(int));
+    if (chain >= 0) {
+        printf("IntervalReach reached the goal through %d runs.\n", chain);
+    } else {
+        printf("No path found\n");
+    }
+    printf("IntervalReach expanded %d runs.\n\n", runsExpanded);
+
+    PrintMap(map);
+    free(seen);
+    FreeRleMap(rle);
+}
+
+// Level16
+void Level16(map_t *map) {
+    LevelHeader(16);
+    RefreshMap(map);
+
+    int count;
+    agent_t *agents = ReadAgents(&count);
+    map->components = BuildComponents(map);
+
+    StatsBegin(map);
+    cooperative_t *coop = CreateCooperative(map);
+    PlanAgents(coop, agents, count);
+    StatsEnd(map);
+
+    int routed = 0, makespan = 0, sumOfCosts = 0;
+    for (int i = 0; i < count; i++) {
+        if (agents[i].steps < 0) {
+            continue;
+        }
+        routed++;
+        sumOfCosts += agents[i].steps;
+        if (makespan < agents[i].steps) {
+            makespan = agents[i].steps;
+        }
+    }
+    RecordStats(map, coop->expanded, 0, sumOfCosts);
+
+    printf("CooperativePaths routed %d of %d agents: makespan %d, "
+           "sum of costs %d.\n", routed, count, makespan, sumOfCosts);
+    printf("CooperativePaths expanded %ld space-time states.\n",
+           coop->expanded);
+    for (int i = 0; i < count; i++) {
+        if (agents[i].steps < 0) {
+            printf("Agent %d: no path\n", i + 1);
+            continue;
+        }
+
+        printf("Agent %d: %d steps, %d waits:", i + 1, agents[i].steps,
+               agents[i].waits);
+        for (int time = 0; time <= agents[i].steps; time++) {
+            int cell = agents[i].path[time];
+            printf(" (%d,%d)", cell / map->cols, cell % map->cols);
+            if (time > 0 && time < agents[i].steps) {
+                SetPath(map, cell / map->cols, cell % map->cols);
             }
         }
+        printf("\n");
     }
+    printf("\n");
+
+    PrintMap(map);
+    for (int i = 0; i < count; i++) {
+        free(agents[i].path);
+    }
+    free(agents);
+    FreeCooperative(coop);
+}
+
+// Function to clear the map
+void ClearMap(map_t *map) {
+    memset(map->blocked, 0, PlaneBytes(map));
+    memset(map->visited, 0, PlaneBytes(map));
+    memset(map->path, 0, PlaneBytes(map));
+    map->startRow = map->startCol = -1;
+    map->endRow = map->endCol = -1;
+}
+
+// Function to make printing out a "clean" map easier
+void RefreshMap(map_t *map) {
+    memset(map->visited, 0, PlaneBytes(map));
+    memset(map->path, 0, PlaneBytes(map));
 }
 
 /*==========================================================*
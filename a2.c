@@ -16,7 +16,7 @@
 #define STAGE_NUM_THREE 3
 #define STAGE_NUM_FOUR 4
 #define STAGE_HEADER "Stage %d\n==========\n"	
-#define VOCABULARY_SIZE 50						
+#define INITIAL_NNZ 64
 #define MAX_TOP_WORDS 10
 #define BEAM_WIDTH 2
 #define MAX_ITERATIONS 10
@@ -24,6 +24,7 @@
 typedef struct word_rec word_rec_t;
 typedef struct language_model language_model_t;
 typedef struct sent sent_t;
+typedef struct successor successor_t;
 typedef struct node node_t;
 typedef struct list list_t;
 typedef int data_t;
@@ -35,11 +36,23 @@ struct word_rec {
 	int index;
 };
 
-/* Language model struct */
+/* Language model struct: the transition matrix is kept in compressed
+ * sparse row (CSR) form, so only its non-zero entries take memory */
 struct language_model{
-	word_rec_t words[VOCABULARY_SIZE];
+	word_rec_t *words;		/* total_words word records */
 	int total_words;
-	double transition[VOCABULARY_SIZE][VOCABULARY_SIZE];
+	int *row_ptr;			/* Row i is entries row_ptr[i] .. row_ptr[i+1]-1 */
+	int *col_idx;			/* Column of each entry; each row is sorted by
+							 * probability descending, then column ascending */
+	double *val;			/* Transition probability of each entry */
+	int nnz;				/* Number of non-zero entries */
+	int nnz_capacity;		/* Entries col_idx and val can hold */
+};
+
+/* One entry of a transition row, used while sorting the row */
+struct successor {
+	int word;
+	double prob;
 };
 
 /* Sentence record struct for Stage 4 */
@@ -78,15 +91,22 @@ void stage_four(language_model_t *model);
 
 /* Helper function prototypes */
 void read_words(language_model_t *model);
+void read_transitions(language_model_t *model);
+void sort_successors(language_model_t *model);
+int compare_successors(const void *a, const void *b);
+void free_model(language_model_t *model);
 void print_top_words(language_model_t *model);
 int get_next_word(language_model_t *model, int current_word);
 void print_sentence(language_model_t *model, list_t *sentence);
 void initialise_beam(sent_t *sentences);
 void expand_beam(language_model_t *model, sent_t *current_sentences, int current_count, 
-				sent_t *new_sentences, int *new_count);
+				sent_t *heap, int *heap_count);
 void expand_single_sentence(language_model_t *model, sent_t *sentence, 
-						   sent_t *new_sentences, int *new_count, int *insertion_counter);
-int prune_beam(sent_t *candidates, int candidate_count, sent_t *selected);
+						   sent_t *heap, int *heap_count, int *insertion_counter);
+void offer_candidate(sent_t *heap, int *heap_count, sent_t *candidate);
+void sift_up(sent_t *heap, int i);
+void sift_down(sent_t *heap, int count, int i);
+int prune_beam(sent_t *heap, int heap_count, sent_t *selected);
 int all_sentences_complete(sent_t *sentences, int count);
 void ensure_sentence_complete(sent_t *sentence);
 void copy_sentence(sent_t *dest, sent_t *src);
@@ -99,7 +119,7 @@ void print_sent_array(language_model_t *model, sent_t *sentence);
 int
 main(int argc, char *argv[]) {
 	language_model_t model;
-	model.total_words = 0;
+	memset(&model, 0, sizeof(model));
 
 	/* Stage 1: Read word records */
 	stage_one(&model); 
@@ -113,6 +133,7 @@ main(int argc, char *argv[]) {
 	/* Stage 4: Generate text with transition probabilities, advanced */
 	stage_four(&model);
 
+	free_model(&model);
 	return 0;
 }
 
@@ -136,27 +157,13 @@ stage_one(language_model_t *model) {
 void 
 stage_two(language_model_t *model) {
 	/* Read transition probability matrix */
-	for (int i = 0; i < model->total_words; i++) {
-		for (int j = 0; j < model->total_words; j++) {
-			scanf("%lf", &model->transition[i][j]);
-		}
-	}
+	read_transitions(model);
 
 	print_stage_header(STAGE_NUM_TWO);
 
 	/* For each word except <end>, find most likely next word */
 	for (int i = 1; i < model->total_words; i++) {
-		int best_next = 0;
-		double max_prob = model->transition[i][0];
-
-		/* Find column with maximum probability, tiebreak by choosing smaller column */
-		for (int j = 1; j < model->total_words; j++) {
-			if (model->transition[i][j] > max_prob) {
-				max_prob = model->transition[i][j];
-				best_next = j;
-			}
-		}
-		
+		int best_next = get_next_word(model, i);
 		printf("%s -> %s\n", model->words[i].word, model->words[best_next].word);
 	}
  	
@@ -214,12 +221,12 @@ stage_four(language_model_t *model) {
 	print_stage_header(STAGE_NUM_FOUR);
 
 	sent_t current_sentences[BEAM_WIDTH];
-	sent_t candidate_sentences[BEAM_WIDTH * VOCABULARY_SIZE];
+	sent_t candidate_heap[BEAM_WIDTH];
 	int current_count = 1;
 
 	/* Zero out all memory to prevent garbage data */
 	memset(current_sentences, 0, sizeof(current_sentences));
-	memset(candidate_sentences, 0, sizeof(candidate_sentences));
+	memset(candidate_heap, 0, sizeof(candidate_heap));
 
 	/* Step 1: Initialise beam search with starting sentence containing "<start>" */
 	initialise_beam(current_sentences);
@@ -229,18 +236,16 @@ stage_four(language_model_t *model) {
 		int candidate_count = 0;
 		
 		/* Step 2: Expansion phase - For each partial sentence in current beam,
-		 * generate all possible extensions by adding words with non-zero transition probabilities
+		 * generate all possible extensions by adding words with non-zero transition probabilities,
+		 * keeping only the best BEAM_WIDTH of them in a bounded min-heap as they are generated
 		 */
 		expand_beam(model, current_sentences, current_count, 
-				   candidate_sentences, &candidate_count);
+				   candidate_heap, &candidate_count);
 
-		/* Step 3: Selection phase - Sort all candidate sentences by probability (descending)
-		 * and keep only top 2 for next iteration
+		/* Step 3: Selection phase - Move the kept candidates into the beam,
+		 * ordered by probability (descending)
 		 */
-		qsort(candidate_sentences, candidate_count, sizeof(sent_t), compare_sentences);
-		
-		/* Keep only top BEAM_WIDTH sentences for next iteration */
-		current_count = prune_beam(candidate_sentences, candidate_count, current_sentences);
+		current_count = prune_beam(candidate_heap, candidate_count, current_sentences);
 		
 		/* Step 4: Termination check - Stop if all sentences end with <end> */
 		if (all_sentences_complete(current_sentences, current_count)) {
@@ -264,12 +269,114 @@ void
 read_words(language_model_t *model) {
 	scanf("%d", &model->total_words);
 
+	model->words = (word_rec_t*)malloc((model->total_words + 1) * 
+									   sizeof(word_rec_t));
+	assert(model->words!=NULL);
 	for (int i = 0; i < model->total_words; i++) {
 		scanf("%20s %lf", model->words[i].word, &model->words[i].probability);
 		model->words[i].index = i;
 	}
 }
 
+/**
+ * @brief: Read the total_words x total_words transition matrix row by row,
+ *         keeping only its non-zero entries in CSR form
+ */
+void
+read_transitions(language_model_t *model) {
+	int n = model->total_words;
+
+	model->row_ptr = (int*)malloc((n + 1) * sizeof(int));
+	model->nnz_capacity = INITIAL_NNZ;
+	model->col_idx = (int*)malloc(model->nnz_capacity * sizeof(int));
+	model->val = (double*)malloc(model->nnz_capacity * sizeof(double));
+	assert(model->row_ptr!=NULL && model->col_idx!=NULL && model->val!=NULL);
+	model->nnz = 0;
+
+	for (int i = 0; i < n; i++) {
+		model->row_ptr[i] = model->nnz;
+		for (int j = 0; j < n; j++) {
+			double prob;
+			scanf("%lf", &prob);
+			if (prob == 0.0) {
+				continue;
+			}
+
+			/* Grow both entry arrays together when they are full */
+			if (model->nnz == model->nnz_capacity) {
+				model->nnz_capacity *= 2;
+				model->col_idx = (int*)realloc(model->col_idx,
+					model->nnz_capacity * sizeof(int));
+				model->val = (double*)realloc(model->val,
+					model->nnz_capacity * sizeof(double));
+				assert(model->col_idx!=NULL && model->val!=NULL);
+			}
+			model->col_idx[model->nnz] = j;
+			model->val[model->nnz] = prob;
+			model->nnz++;
+		}
+	}
+	model->row_ptr[n] = model->nnz;
+	sort_successors(model);
+}
+
+/**
+ * @brief: Sort the entries of every transition row once, by probability
+ *         descending and then column ascending, so the most likely next
+ *         word of a row is always its first entry
+ */
+void
+sort_successors(language_model_t *model) {
+	successor_t *row;
+
+	row = (successor_t*)malloc((model->total_words + 1) * sizeof(successor_t));
+	assert(row!=NULL);
+	for (int i = 0; i < model->total_words; i++) {
+		int start = model->row_ptr[i];
+		int len = model->row_ptr[i + 1] - start;
+
+		for (int k = 0; k < len; k++) {
+			row[k].word = model->col_idx[start + k];
+			row[k].prob = model->val[start + k];
+		}
+		qsort(row, len, sizeof(successor_t), compare_successors);
+		for (int k = 0; k < len; k++) {
+			model->col_idx[start + k] = row[k].word;
+			model->val[start + k] = row[k].prob;
+		}
+	}
+	free(row);
+}
+
+/**
+ * @brief: Compare two row entries for sorting, higher probability first,
+ *         smaller column first on ties
+ */
+int
+compare_successors(const void *a, const void *b) {
+	const successor_t *succ_a = (const successor_t *)a;
+	const successor_t *succ_b = (const successor_t *)b;
+
+	if (succ_a->prob > succ_b->prob) {
+		return -1;
+	} else if (succ_a->prob < succ_b->prob) {
+		return 1;
+	} else {
+		return succ_a->word - succ_b->word;
+	}
+}
+
+/**
+ * @brief: Free the word records and transition matrix of the model
+ */
+void
+free_model(language_model_t *model) {
+	free(model->words);
+	free(model->row_ptr);
+	free(model->col_idx);
+	free(model->val);
+}
+
 /** 
  * @brief: Filter, sort, print the top words by probability
  * Insertion sort adapted from Alistair Moffat's example for the book
@@ -280,9 +387,13 @@ read_words(language_model_t *model) {
  */
 void 
 print_top_words(language_model_t *model) {
-	word_rec_t words_sorted[VOCABULARY_SIZE];
+	word_rec_t *words_sorted;
 	int sorted_count = 0;
 
+	words_sorted = (word_rec_t*)malloc((model->total_words + 1) * 
+									   sizeof(word_rec_t));
+	assert(words_sorted!=NULL);
+
 	/* Filter out <start> and <end> */
 	for (int i = 0; i < model->total_words; i++) {
 		const char *w = model->words[i].word;
@@ -312,25 +423,24 @@ print_top_words(language_model_t *model) {
 		printf(" %s", words_sorted[i].word);
 	}
 	printf(" <end>\n");
+	free(words_sorted);
 }
 
 /** 
  * @brief: Get the next word based on transition probabilities
+ *         Rows are sorted at load, so the most likely word (smaller column
+ *         on ties) is the row's first entry; a missing column has
+ *         probability 0, so <end> (column 0) wins when the row is empty
  * @return: 0 if "<end>" is reached, otherwise return the index of the next word
  */
 int
 get_next_word(language_model_t *model, int current_word) {
-	int best_next = 0;
-	double max_prob = model->transition[current_word][0];
+	int first = model->row_ptr[current_word];
 
-	for (int j = 1; j < model->total_words; j++) {
-		if (model->transition[current_word][j] > max_prob) {
-			max_prob = model->transition[current_word][j];
-			best_next = j;
-		}
+	if (first == model->row_ptr[current_word + 1] || model->val[first] <= 0.0) {
+		return 0;
 	}
-	
-	return best_next;
+	return model->col_idx[first];
 }
 
 /** 
@@ -371,68 +481,133 @@ initialise_beam(sent_t *sentences) {
  */
 void 
 expand_beam(language_model_t *model, sent_t *current_sentences, int current_count, 
-		   sent_t *new_sentences, int *new_count) {
-	*new_count = 0;
+		   sent_t *heap, int *heap_count) {
+	*heap_count = 0;
 	int insertion_counter = 0;
 	
 	for (int i = 0; i < current_count; i++) {
-		/* If sentence already ends with <end>, copy unchanged to candidates */
+		/* If sentence already ends with <end>, offer it unchanged */
 		if (current_sentences[i].last == 0) {
-			copy_sentence(&new_sentences[*new_count], &current_sentences[i]);
-			new_sentences[*new_count].insertion_order = insertion_counter++;
-			(*new_count)++;
+			sent_t candidate;
+			copy_sentence(&candidate, &current_sentences[i]);
+			candidate.insertion_order = insertion_counter++;
+			offer_candidate(heap, heap_count, &candidate);
 		} else {
 			/* Otherwise, generate all possible extensions */
 			expand_single_sentence(model, &current_sentences[i], 
-								 new_sentences, new_count, &insertion_counter);
+								 heap, heap_count, &insertion_counter);
 		}
 	}
 }
 
 /**
  * @brief: Expand a single sentence with all possible next words
+ *         The last word's row is sorted by probability, and each extension
+ *         is inserted later than every kept candidate, so once one is no
+ *         better than the heap's worst no later entry of the row can be
+ *         either and expansion stops
  */
 void 
 expand_single_sentence(language_model_t *model, sent_t *sentence, 
-					  sent_t *new_sentences, int *new_count, int *insertion_counter) {
-	for (int next_word = 0; next_word < model->total_words; next_word++) {
-		double trans_prob = model->transition[sentence->last][next_word];
+					  sent_t *heap, int *heap_count, int *insertion_counter) {
+	for (int k = model->row_ptr[sentence->last]; 
+		 k < model->row_ptr[sentence->last + 1]; k++) {
+		int next_word = model->col_idx[k];
+		double trans_prob = model->val[k];
+		sent_t candidate;
 		
+		if (*heap_count == BEAM_WIDTH && 
+			sentence->probability * trans_prob <= heap[0].probability) {
+			break;
+		}
 		if (trans_prob > 0.0) {
-			/* Bounds check: Ensure we don't overflow arrays */
-			if (*new_count >= BEAM_WIDTH * VOCABULARY_SIZE) {
-				break;
-			}
 			if (sentence->length >= MAX_TOP_WORDS + 2) {
 				break;
 			}
 
 			/* Create new sentence by extending current sentence with next_word */
-			copy_sentence(&new_sentences[*new_count], sentence);
-			new_sentences[*new_count].sentence[sentence->length] = next_word;
-			new_sentences[*new_count].last = next_word;
+			copy_sentence(&candidate, sentence);
+			candidate.sentence[sentence->length] = next_word;
+			candidate.last = next_word;
 
 			/* Maintain sentence probability by multiplying transition probabilities */
-			new_sentences[*new_count].probability *= trans_prob;
-			new_sentences[*new_count].length++;
-			new_sentences[*new_count].insertion_order = (*insertion_counter)++;
-			(*new_count)++;
+			candidate.probability *= trans_prob;
+			candidate.length++;
+			candidate.insertion_order = (*insertion_counter)++;
+			offer_candidate(heap, heap_count, &candidate);
 		}
 	}
 }
 
 /**
- * @brief: Select the top BEAM_WIDTH sentences from candidates
+ * @brief: Offer a candidate to the bounded min-heap of the best BEAM_WIDTH
+ *         sentences, whose root is the worst kept one by compare_sentences;
+ *         a full heap replaces its root only if the candidate beats it
+ */
+void
+offer_candidate(sent_t *heap, int *heap_count, sent_t *candidate) {
+	if (*heap_count < BEAM_WIDTH) {
+		copy_sentence(&heap[*heap_count], candidate);
+		sift_up(heap, (*heap_count)++);
+	} else if (compare_sentences(candidate, &heap[0]) < 0) {
+		copy_sentence(&heap[0], candidate);
+		sift_down(heap, *heap_count, 0);
+	}
+}
+
+/**
+ * @brief: Move heap[i] up while it ranks below its parent
+ */
+void
+sift_up(sent_t *heap, int i) {
+	while (i > 0 && compare_sentences(&heap[i], &heap[(i - 1) / 2]) > 0) {
+		sent_t tmp = heap[i];
+		heap[i] = heap[(i - 1) / 2];
+		heap[(i - 1) / 2] = tmp;
+		i = (i - 1) / 2;
+	}
+}
+
+/**
+ * @brief: Move heap[i] down while one of its children ranks below it
+ */
+void
+sift_down(sent_t *heap, int count, int i) {
+	for (;;) {
+		int worst = i;
+		int left = 2 * i + 1;
+		int right = 2 * i + 2;
+
+		if (left < count && compare_sentences(&heap[left], &heap[worst]) > 0) {
+			worst = left;
+		}
+		if (right < count && compare_sentences(&heap[right], &heap[worst]) > 0) {
+			worst = right;
+		}
+		if (worst == i) {
+			return;
+		}
+		sent_t tmp = heap[i];
+		heap[i] = heap[worst];
+		heap[worst] = tmp;
+		i = worst;
+	}
+}
+
+/**
+ * @brief: Empty the candidate heap into selected, best sentence first
+ * @return: the number of sentences selected
  */
 int 
-prune_beam(sent_t *candidates, int candidate_count, sent_t *selected) {
-	int selected_count = (candidate_count < BEAM_WIDTH) ? candidate_count : BEAM_WIDTH;
-	
-	for (int i = 0; i < selected_count; i++) {
-		copy_sentence(&selected[i], &candidates[i]);
+prune_beam(sent_t *heap, int heap_count, sent_t *selected) {
+	/* Popping the root yields the worst remaining, so fill from the back */
+	for (int n = heap_count; n > 0; n--) {
+		copy_sentence(&selected[n - 1], &heap[0]);
+		heap[0] = heap[n - 1];
+		sift_down(heap, n - 1, 0);
 	}
 	
-	return selected_count;
+	return heap_count;
 }
 
 /**
@@ -477,7 +652,7 @@ copy_sentence(sent_t *dest, sent_t *src) {
 }
 
 /**
- * @brief: Comparator for qsort - sorts by probability (descending), 
+ * @brief: Ranks sentences by probability (descending) for the beam heap,
  * 		   maintains original order for ties
  * 		   This implements the required tie-breaking rule: earlier records win ties
  */
@@ -586,12 +761,13 @@ list_t
 	What is the worst-case time complexity of the algorithm described in Stage 4, 
 	and why?
 	
-	Answer: O(L * K * N * log(K * N))
+	Answer: O(L * K * N * log K)
 	
 	Explanation:
 	- For each of L iterations (maximum sentence length)
 	- We expand K partial sentences, each trying N possible next words: O(K * N)
-	- We then sort K * N candidates using qsort: O(K * N * log(K * N))
-	- Total per iteration: O(K * N + K * N * log(K * N)) = O(K * N * log(K * N))
-	- Over L iterations: O(L * K * N * log(K * N))
+	- Each candidate is offered to a min-heap holding the best K: O(log K) each
+	- Emptying the heap into the next beam: O(K * log K)
+	- Total per iteration: O(K * N * log K)
+	- Over L iterations: O(L * K * N * log K)
 */